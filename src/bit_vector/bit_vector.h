@@ -0,0 +1,395 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "vector/growth_policy.h"
+#include "vector/index_iterator.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+// Bit i of a BitVector, as returned by its non-const indexing and iterators
+class BitReference {
+    template <typename, typename>
+    friend class BitVector;
+
+    BitReference(uint64_t* word, uint64_t mask) noexcept
+        : word_(word)
+        , mask_(mask)
+    {
+    }
+
+public:
+    BitReference(const BitReference&) = default;
+
+    operator bool() const noexcept {
+        return *word_ & mask_;
+    }
+
+    // Assignments write through to the referenced bit
+    BitReference& operator=(bool value) noexcept {
+        *word_ = value ? *word_ | mask_ : *word_ & ~mask_;
+        return *this;
+    }
+
+    BitReference& operator=(const BitReference& rhs) noexcept {
+        return *this = static_cast<bool>(rhs);
+    }
+
+    void Flip() noexcept {
+        *word_ ^= mask_;
+    }
+
+private:
+    uint64_t* word_;
+    uint64_t mask_;
+};
+
+// Sequence of bits packed 64 per word into a RawMemory: an eighth of the
+// memory of one byte per flag, and whole-vector operations work a word at a
+// time. The word loops below are plain and branch-free so the compiler
+// vectorizes them; Count uses std::popcount, a single instruction where the
+// target has one (e.g. -mpopcnt or -march=native on x86).
+//
+// Bits past Size() in the last word are kept zero.
+template <typename Allocator = std::allocator<uint64_t>,
+          typename GrowthPolicy = DoublingGrowth<>>
+class BitVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static constexpr size_t WORD_BITS = 64;
+
+    template <bool IsConst>
+    struct IteratorAccess {
+        using Container = BitVector;
+        using Handle = std::conditional_t<IsConst, const BitVector*, BitVector*>;
+        using value_type = bool;
+        using pointer = void;
+        using reference = std::conditional_t<IsConst, bool, BitReference>;
+
+        static reference Get(Handle bits, size_t index) noexcept {
+            return (*bits)[index];
+        }
+    };
+
+public:
+    using value_type = bool;
+    using reference = BitReference;
+    using const_reference = bool;
+    using allocator_type = Allocator;
+    using iterator = detail::IndexIterator<IteratorAccess, false>;
+    using const_iterator = detail::IndexIterator<IteratorAccess, true>;
+
+public:
+    BitVector() = default;
+
+    explicit BitVector(const Allocator& alloc) noexcept
+            : words_(alloc) {
+    }
+
+    explicit BitVector(size_t size, bool value = false, const Allocator& alloc = Allocator())
+            : words_(WordsFor(size), alloc)
+            , size_(size) {
+        std::fill_n(words_.GetAddress(), WordsFor(size), value ? ~uint64_t{0} : 0);
+        ClearTail();
+    }
+
+    BitVector(const BitVector& other)
+            : words_(
+                other.WordCount(),
+                std::allocator_traits<Allocator>::select_on_container_copy_construction(
+                    other.GetAllocator()
+                )
+            )
+            , size_(other.size_)
+            , growth_(other.growth_) {
+        std::copy_n(other.words_.GetAddress(), WordCount(), words_.GetAddress());
+    }
+
+    BitVector(BitVector&& other) noexcept
+            : words_(std::move(other.words_))
+            , size_(std::exchange(other.size_, 0))
+            , growth_(std::move(other.growth_)) {
+    }
+
+    BitVector& operator=(const BitVector& rhs) {
+        if (this == &rhs)
+            return *this;
+
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            if (GetAllocator() != rhs.GetAllocator())
+                words_.Reset(rhs.GetAllocator());
+        }
+        CopyWords(rhs);
+        return *this;
+    }
+
+    BitVector& operator=(BitVector&& rhs) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value
+        || AllocTraits::is_always_equal::value
+    ) {
+        if (this == &rhs)
+            return *this;
+
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            words_ = std::move(rhs.words_);
+            size_ = std::exchange(rhs.size_, 0);
+            growth_ = std::move(rhs.growth_);
+        } else if (GetAllocator() == rhs.GetAllocator()) {
+            Swap(rhs);
+        } else {
+            CopyWords(rhs);
+        }
+        return *this;
+    }
+
+    bool operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return words_[index/WORD_BITS] >> index % WORD_BITS & 1;
+    }
+
+    BitReference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return {words_ + index/WORD_BITS, uint64_t{1} << index % WORD_BITS};
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+    // The packed words, bit i of the vector being bit i % 64 of word i / 64
+    std::span<const uint64_t> Words() const noexcept {
+        return {words_.GetAddress(), WordCount()};
+    }
+
+    void Swap(BitVector& other) noexcept {
+        words_.Swap(other.words_);
+        std::swap(size_, other.size_);
+        std::swap(growth_, other.growth_);
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return words_.GetAllocator();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    // In bits
+    size_t Capacity() const noexcept {
+        return words_.Capacity()*WORD_BITS;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > Capacity())
+            Reallocate(WordsFor(new_capacity));
+    }
+
+    void Resize(size_t new_size, bool value = false) {
+        if (new_size > size_) {
+            Reserve(new_size);
+            const size_t old_words = WordCount();
+            std::fill_n(words_ + old_words, WordsFor(new_size) - old_words,
+                        value ? ~uint64_t{0} : 0);
+            if (value && size_ % WORD_BITS)
+                words_[size_/WORD_BITS] |= ~uint64_t{0} << size_ % WORD_BITS;
+        }
+        size_ = new_size;
+        ClearTail();
+    }
+
+    void Clear() noexcept {
+        size_ = 0;
+    }
+
+    void PushBack(bool value) {
+        if (size_ == Capacity())
+            Reallocate(growth_.NextCapacity(words_.Capacity(), WordCount() + 1, sizeof(uint64_t)));
+        if (size_ % WORD_BITS == 0)
+            words_[size_/WORD_BITS] = 0;
+        words_[size_/WORD_BITS] |= uint64_t{value} << size_ % WORD_BITS;
+        ++size_;
+    }
+
+    void PopBack() noexcept {
+        assert(size_);
+
+        --size_;
+        ClearTail();
+    }
+
+    // ---------- Whole-vector operations -
+
+    // Number of set bits
+    size_t Count() const noexcept {
+        const uint64_t* words = words_.GetAddress();
+        size_t count = 0;
+        for (size_t i = 0, n = WordCount(); i < n; ++i)
+            count += std::popcount(words[i]);
+        return count;
+    }
+
+    // Index of the first set bit, Size() if none
+    size_t FindFirst() const noexcept {
+        return FindFrom(0);
+    }
+
+    // Index of the first set bit after `pos`, Size() if none
+    size_t FindNext(size_t pos) const noexcept {
+        return pos + 1 < size_ ? FindFrom(pos + 1) : size_;
+    }
+
+    void SetAll() noexcept {
+        std::fill_n(words_.GetAddress(), WordCount(), ~uint64_t{0});
+        ClearTail();
+    }
+
+    void ResetAll() noexcept {
+        std::fill_n(words_.GetAddress(), WordCount(), 0);
+    }
+
+    void FlipAll() noexcept {
+        Apply([](uint64_t word) { return ~word; });
+        ClearTail();
+    }
+
+    // Both vectors must have the same size
+    BitVector& operator&=(const BitVector& rhs) noexcept {
+        return Combine(rhs, [](uint64_t lhs, uint64_t rhs) { return lhs & rhs; });
+    }
+
+    BitVector& operator|=(const BitVector& rhs) noexcept {
+        return Combine(rhs, [](uint64_t lhs, uint64_t rhs) { return lhs | rhs; });
+    }
+
+    BitVector& operator^=(const BitVector& rhs) noexcept {
+        return Combine(rhs, [](uint64_t lhs, uint64_t rhs) { return lhs ^ rhs; });
+    }
+
+    // Clears the bits set in `rhs`
+    BitVector& AndNot(const BitVector& rhs) noexcept {
+        return Combine(rhs, [](uint64_t lhs, uint64_t rhs) { return lhs & ~rhs; });
+    }
+
+    friend BitVector operator&(BitVector lhs, const BitVector& rhs) {
+        return lhs &= rhs;
+    }
+
+    friend BitVector operator|(BitVector lhs, const BitVector& rhs) {
+        return lhs |= rhs;
+    }
+
+    friend BitVector operator^(BitVector lhs, const BitVector& rhs) {
+        return lhs ^= rhs;
+    }
+
+    friend bool operator==(const BitVector& lhs, const BitVector& rhs) noexcept {
+        return lhs.size_ == rhs.size_
+               && std::equal(lhs.Words().begin(), lhs.Words().end(), rhs.Words().begin());
+    }
+
+private:
+    RawMemory<uint64_t, Allocator> words_;
+    size_t size_ = 0;
+    [[no_unique_address]] GrowthPolicy growth_{};
+
+    static size_t WordsFor(size_t bits) noexcept {
+        return (bits + WORD_BITS - 1)/WORD_BITS;
+    }
+
+    size_t WordCount() const noexcept {
+        return WordsFor(size_);
+    }
+
+    void ClearTail() noexcept {
+        if (size_ % WORD_BITS)
+            words_[size_/WORD_BITS] &= ~(~uint64_t{0} << size_ % WORD_BITS);
+    }
+
+    // Copies the bits of `other` into memory from this vector's allocator
+    void CopyWords(const BitVector& other) {
+        if (other.WordCount() > words_.Capacity()) {
+            RawMemory<uint64_t, Allocator> new_data(other.WordCount(), GetAllocator());
+            words_.Swap(new_data);
+        }
+        std::copy_n(other.words_.GetAddress(), other.WordCount(), words_.GetAddress());
+        size_ = other.size_;
+        growth_ = other.growth_;
+    }
+
+    void Reallocate(size_t new_words) {
+        RawMemory<uint64_t, Allocator> new_data(new_words, GetAllocator());
+        std::copy_n(words_.GetAddress(), WordCount(), new_data.GetAddress());
+        words_.Swap(new_data);
+    }
+
+    size_t FindFrom(size_t pos) const noexcept {
+        const size_t n = WordCount();
+        size_t i = pos/WORD_BITS;
+        if (i >= n)
+            return size_;
+
+        uint64_t word = words_[i] & ~uint64_t{0} << pos % WORD_BITS;
+        while (!word) {
+            if (++i == n)
+                return size_;
+            word = words_[i];
+        }
+        return i*WORD_BITS + std::countr_zero(word);
+    }
+
+    template <typename Op>
+    void Apply(Op op) noexcept {
+        uint64_t* words = words_.GetAddress();
+        for (size_t i = 0, n = WordCount(); i < n; ++i)
+            words[i] = op(words[i]);
+    }
+
+    template <typename Op>
+    BitVector& Combine(const BitVector& rhs, Op op) noexcept {
+        assert(size_ == rhs.size_);
+
+        uint64_t* __restrict words = words_.GetAddress();
+        const uint64_t* __restrict other = rhs.words_.GetAddress();
+        if (words == other) {
+            Apply([op](uint64_t word) { return op(word, word); });
+            return *this;
+        }
+        for (size_t i = 0, n = WordCount(); i < n; ++i)
+            words[i] = op(words[i], other[i]);
+        return *this;
+    }
+};
+
+} // namespace cstl
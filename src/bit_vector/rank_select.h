@@ -0,0 +1,166 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "bit_vector/bit_vector.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+// Rank and select over the bits of a BitVector from an auxiliary index
+// (Vigna's rank9): for each block of 512 bits, the number of set bits
+// before it and, packed into a second word as 9-bit fields, the number
+// before each of its words within the block. Rank is then two loads and a
+// popcount. Select starts from a sample taken every 512 set bits and
+// searches only the blocks up to the next sample, then the words of one
+// block.
+//
+// The index is about a quarter of the size of the vector. It refers to
+// the vector's words, so the vector must outlive it, and it describes the
+// bits as they were when it was built.
+class RankSelect {
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t BLOCK_WORDS = 8;
+    static constexpr size_t SAMPLE_RATE = 512;
+
+public:
+    // Indexes an empty vector: only the block holding the total, zero
+    RankSelect() {
+        blocks_.Resize(2);
+    }
+
+    template <typename Allocator, typename GrowthPolicy>
+    explicit RankSelect(const BitVector<Allocator, GrowthPolicy>& bits)
+            : words_(bits.Words().data())
+            , word_count_(bits.Words().size())
+            , size_(bits.Size()) {
+        // One block past the last holds the total
+        const size_t block_count = (word_count_ + BLOCK_WORDS - 1)/BLOCK_WORDS + 1;
+        blocks_.Reserve(2*block_count);
+
+        uint64_t rank = 0;
+        for (size_t block = 0; block < block_count; ++block) {
+            const uint64_t block_rank = rank;
+            uint64_t relative = 0;
+            for (size_t i = 0; i < BLOCK_WORDS; ++i) {
+                if (i)
+                    relative |= (rank - block_rank) << 9*(i - 1);
+                rank += std::popcount(Word(block*BLOCK_WORDS + i));
+            }
+            blocks_.PushBack(block_rank);
+            blocks_.PushBack(relative);
+        }
+        count_ = BlockRank(block_count - 1);
+
+        for (size_t block = 0; block + 1 < block_count; ++block) {
+            while (samples_.Size()*SAMPLE_RATE < BlockRank(block + 1))
+                samples_.PushBack(block);
+        }
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    // Number of set bits
+    size_t Count() const noexcept {
+        return count_;
+    }
+
+    // Number of set bits in [0, pos), for pos <= Size()
+    size_t Rank(size_t pos) const noexcept {
+        assert(pos <= size_);
+
+        const size_t word = pos/WORD_BITS;
+        const size_t block = word/BLOCK_WORDS;
+        // For the first word of a block t wraps around and selects bit 63
+        // of the packed counts, which is always zero
+        const uint64_t t = word % BLOCK_WORDS - 1;
+        size_t rank = BlockRank(block)
+                      + (blocks_[2*block + 1] >> 9*(t + (t >> 60 & 8)) & 0x1ff);
+        if (pos % WORD_BITS)
+            rank += std::popcount(words_[word] & ~(~uint64_t{0} << pos % WORD_BITS));
+        return rank;
+    }
+
+    // Index of the set bit with rank k (k = 0 is the first one), Size() if
+    // there are not more than k set bits
+    size_t Select(size_t k) const noexcept {
+        if (k >= count_)
+            return size_;
+
+        // Last block whose rank is at most k, between two samples
+        const size_t sample = k/SAMPLE_RATE;
+        size_t first = samples_[sample];
+        size_t last = sample + 1 < samples_.Size() ? samples_[sample + 1] + 1
+                                                   : blocks_.Size()/2 - 1;
+        while (last - first > 1) {
+            const size_t mid = first + (last - first)/2;
+            if (BlockRank(mid) <= k)
+                first = mid;
+            else
+                last = mid;
+        }
+        const size_t block = first;
+
+        size_t rest = k - BlockRank(block);
+        const uint64_t relative = blocks_[2*block + 1];
+        size_t i = BLOCK_WORDS - 1;
+        for (; i > 0; --i) {
+            const size_t before = relative >> 9*(i - 1) & 0x1ff;
+            if (before <= rest) {
+                rest -= before;
+                break;
+            }
+        }
+        const size_t word = block*BLOCK_WORDS + i;
+        return word*WORD_BITS + SelectInWord(words_[word], rest);
+    }
+
+private:
+    const uint64_t* words_ = nullptr;
+    size_t word_count_ = 0;
+    size_t size_ = 0;
+    size_t count_ = 0;
+    // Per block: rank of its first bit, then the packed relative ranks of
+    // its words 1 ... 7
+    Vector<uint64_t> blocks_;
+    // Block holding the set bit of rank i*SAMPLE_RATE
+    Vector<size_t> samples_;
+
+    uint64_t Word(size_t index) const noexcept {
+        return index < word_count_ ? words_[index] : 0;
+    }
+
+    size_t BlockRank(size_t block) const noexcept {
+        return blocks_[2*block];
+    }
+
+    // Position of the set bit of rank k in `word`, which has more than k
+    static size_t SelectInWord(uint64_t word, size_t k) noexcept {
+#if defined(__BMI2__)
+        return std::countr_zero(_pdep_u64(uint64_t{1} << k, word));
+#else
+        size_t shift = 0;
+        for (;; shift += 8) {
+            const size_t count = std::popcount(word >> shift & 0xff);
+            if (k < count)
+                break;
+            k -= count;
+        }
+        uint64_t byte = word >> shift & 0xff;
+        for (; k; --k)
+            byte &= byte - 1;
+        return shift + std::countr_zero(byte);
+#endif
+    }
+};
+
+} // namespace cstl
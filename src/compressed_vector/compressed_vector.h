@@ -0,0 +1,430 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "vector/vector.h"
+
+namespace cstl {
+
+// How a block of a CompressedVector is encoded
+enum class BlockCodec : uint8_t {
+    // Offsets from the block minimum, each in as many bits as the largest
+    // needs: any element decodes on its own
+    FrameOfReference,
+    // The first element, then the differences between neighbours, packed
+    // as offsets from the smallest difference: for sorted data with regular
+    // gaps, decoded with a prefix sum
+    DeltaFrameOfReference,
+    // The first element, then zigzag-encoded differences between neighbours
+    // as LEB128 varints: for sorted data with a few large gaps, decoded
+    // front to back
+    DeltaVarint,
+};
+
+// Append-only vector of integers stored in blocks of BLOCK_SIZE elements,
+// each block encoded with whichever codec makes it smaller. Sorted IDs and
+// timestamps typically take one or two bytes per element instead of eight.
+// Elements are appended to an uncompressed tail, which is encoded as soon as
+// it fills a block.
+//
+// operator[] decodes one element (FrameOfReference) or a block prefix (the
+// delta codecs); scans should use ForEachBlock or the iterators, which
+// decode a whole block at a time. Bit-unpacking has one routine per bit
+// width, so its shifts and masks are constants the compiler unrolls and
+// vectorizes.
+template <std::integral Int>
+class CompressedVector {
+public:
+    static constexpr size_t BLOCK_SIZE = 128;
+
+private:
+    // Blocks are encoded as unsigned 64-bit values in the same order as the
+    // elements, so differences and minimums work alike for signed types
+    static constexpr uint64_t SIGN_FLIP = std::is_signed_v<Int> ? uint64_t{1} << 63 : 0;
+
+    static uint64_t ToBits(Int value) noexcept {
+        return static_cast<uint64_t>(static_cast<int64_t>(value)) ^ SIGN_FLIP;
+    }
+
+    static Int FromBits(uint64_t bits) noexcept {
+        return static_cast<Int>(bits ^ SIGN_FLIP);
+    }
+
+    struct Block {
+        // The minimum, or the first element for the delta codecs
+        uint64_t base;
+        // Into words_
+        uint64_t offset : 55;
+        uint64_t bits : 7;
+        uint64_t codec : 2;
+    };
+
+    using Unpacker = void (*)(const uint64_t* in, uint64_t base, uint64_t* out);
+
+public:
+    using value_type = Int;
+
+    // Decodes the block of the current element when it is entered, so
+    // copies are as large as a block; prefer ForEachBlock for scans
+    class Iterator {
+        friend class CompressedVector;
+
+        Iterator(const CompressedVector* owner, size_t index)
+            : owner_(owner)
+            , index_(index)
+        {
+            if (index_ < owner_->Size())
+                owner_->DecodeBlock(index_/BLOCK_SIZE, buffer_.data());
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Int*;
+        using reference = const Int&;
+
+        Iterator() = default;
+
+        [[nodiscard]] reference operator*() const noexcept {
+            return buffer_[index_ % BLOCK_SIZE];
+        }
+
+        Iterator& operator++() {
+            ++index_;
+            if (index_ % BLOCK_SIZE == 0 && index_ < owner_->Size())
+                owner_->DecodeBlock(index_/BLOCK_SIZE, buffer_.data());
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old_value(*this);
+            ++*this;
+            return old_value;
+        }
+
+        [[nodiscard]] friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+    private:
+        const CompressedVector* owner_ = nullptr;
+        size_t index_ = 0;
+        std::array<Int, BLOCK_SIZE> buffer_;
+    };
+
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+
+public:
+    CompressedVector() = default;
+
+    CompressedVector(std::initializer_list<Int> values) {
+        for (const Int value : values)
+            PushBack(value);
+    }
+
+    Int operator[](size_t index) const noexcept {
+        assert(index < Size());
+
+        const size_t block_index = index/BLOCK_SIZE;
+        const size_t position = index % BLOCK_SIZE;
+        if (block_index == blocks_.Size())
+            return tail_[position];
+
+        const Block& block = blocks_[block_index];
+        const uint64_t* words = words_.begin() + block.offset;
+        uint64_t value = block.base;
+        switch (static_cast<BlockCodec>(block.codec)) {
+        case BlockCodec::FrameOfReference:
+            value += Extract(words, position*block.bits, block.bits);
+            break;
+        case BlockCodec::DeltaFrameOfReference:
+            // The first word holds the smallest difference
+            for (size_t i = 1; i <= position; ++i)
+                value += words[0] + Extract(words + 1, i*block.bits, block.bits);
+            break;
+        case BlockCodec::DeltaVarint: {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(words);
+            for (size_t i = 0; i < position; ++i)
+                value += Unzigzag(ReadVarint(bytes));
+            break;
+        }
+        }
+        return FromBits(value);
+    }
+
+    iterator begin() const {
+        return {this, 0};
+    }
+
+    iterator end() const {
+        return {this, Size()};
+    }
+
+    iterator cbegin() const {
+        return begin();
+    }
+
+    iterator cend() const {
+        return end();
+    }
+
+    size_t Size() const noexcept {
+        return blocks_.Size()*BLOCK_SIZE + tail_.Size();
+    }
+
+    // Blocks including the partial last one
+    size_t BlockCount() const noexcept {
+        return (Size() + BLOCK_SIZE - 1)/BLOCK_SIZE;
+    }
+
+    BlockCodec GetBlockCodec(size_t block) const noexcept {
+        assert(block < blocks_.Size());
+        return static_cast<BlockCodec>(blocks_[block].codec);
+    }
+
+    // Bytes taken by the encoded blocks, their headers and the tail
+    size_t MemoryUsage() const noexcept {
+        return words_.Size()*sizeof(uint64_t)
+               + blocks_.Size()*sizeof(Block)
+               + tail_.Size()*sizeof(Int);
+    }
+
+    void Clear() noexcept {
+        words_.Clear();
+        blocks_.Clear();
+        tail_.Clear();
+    }
+
+    void PushBack(Int value) {
+        if (!tail_.Capacity())
+            tail_.Reserve(BLOCK_SIZE);
+        tail_.PushBack(value);
+        if (tail_.Size() == BLOCK_SIZE) {
+            // Encode changes nothing if it throws; the element is dropped
+            // so the tail stays short of a full block
+            try {
+                Encode(tail_.begin());
+            } catch (...) {
+                tail_.PopBack();
+                throw;
+            }
+            tail_.Clear();
+        }
+    }
+
+    // Writes the elements of `block` to `out`, which has room for
+    // BLOCK_SIZE; returns their number
+    size_t DecodeBlock(size_t block_index, Int* out) const noexcept {
+        assert(block_index < BlockCount());
+
+        if (block_index == blocks_.Size()) {
+            std::copy(tail_.begin(), tail_.end(), out);
+            return tail_.Size();
+        }
+
+        const Block& block = blocks_[block_index];
+        const uint64_t* words = words_.begin() + block.offset;
+        std::array<uint64_t, BLOCK_SIZE> bits;
+        switch (static_cast<BlockCodec>(block.codec)) {
+        case BlockCodec::FrameOfReference:
+            GetUnpackers()[block.bits](words, block.base, bits.data());
+            break;
+        case BlockCodec::DeltaFrameOfReference:
+            GetUnpackers()[block.bits](words + 1, words[0], bits.data());
+            bits[0] = block.base;
+            std::inclusive_scan(bits.begin(), bits.end(), bits.begin());
+            break;
+        case BlockCodec::DeltaVarint: {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(words);
+            bits[0] = block.base;
+            for (size_t i = 1; i < BLOCK_SIZE; ++i)
+                bits[i] = bits[i - 1] + Unzigzag(ReadVarint(bytes));
+            break;
+        }
+        }
+        std::transform(bits.begin(), bits.end(), out, FromBits);
+        return BLOCK_SIZE;
+    }
+
+    // Calls fn(std::span<const Int>) with the elements of each block in turn
+    template <typename Fn>
+    void ForEachBlock(Fn fn) const {
+        std::array<Int, BLOCK_SIZE> buffer;
+        for (size_t i = 0, n = BlockCount(); i < n; ++i) {
+            const size_t count = DecodeBlock(i, buffer.data());
+            fn(std::span<const Int>(buffer.data(), count));
+        }
+    }
+
+private:
+    Vector<uint64_t> words_;
+    Vector<Block> blocks_;
+    Vector<Int> tail_;
+
+    // ---------- Encoding ----------------
+
+    // Encodes a full block with the codec taking the fewest words; ties go
+    // to the faster one to decode
+    void Encode(const Int* values) {
+        std::array<uint64_t, BLOCK_SIZE> bits;
+        std::transform(values, values + BLOCK_SIZE, bits.begin(), ToBits);
+
+        const auto [min, max] = std::minmax_element(bits.begin(), bits.end());
+        const size_t width = std::bit_width(*max - *min);
+        const size_t for_words = BLOCK_SIZE*width/64;
+
+        std::array<uint64_t, BLOCK_SIZE> deltas;
+        deltas[0] = 0;
+        for (size_t i = 1; i < BLOCK_SIZE; ++i)
+            deltas[i] = bits[i] - bits[i - 1];
+        const auto [min_delta, max_delta] = std::minmax_element(deltas.begin() + 1, deltas.end());
+        const size_t delta_width = std::bit_width(*max_delta - *min_delta);
+        const size_t delta_words = 1 + BLOCK_SIZE*delta_width/64;
+
+        // Up to 10 bytes a varint; written only while they could still win
+        const size_t best_words = std::min(for_words, delta_words);
+        std::array<uint8_t, (BLOCK_SIZE - 1)*10> varints;
+        size_t varint_bytes = 0;
+        for (size_t i = 1; i < BLOCK_SIZE && varint_bytes < best_words*sizeof(uint64_t); ++i)
+            varint_bytes = WriteVarint(Zigzag(bits[i] - bits[i - 1]), varints.data(), varint_bytes);
+        const size_t varint_words = (varint_bytes + sizeof(uint64_t) - 1)/sizeof(uint64_t);
+
+        // A delta codec wins only with fewer words than FrameOfReference,
+        // which takes at most BLOCK_SIZE
+        std::array<uint64_t, BLOCK_SIZE> encoded{};
+        const size_t offset = words_.Size();
+        Block block;
+        size_t count;
+        if (for_words <= std::min(delta_words, varint_words)) {
+            block = {*min, offset, width, Codec(BlockCodec::FrameOfReference)};
+            for (size_t i = 0; i < BLOCK_SIZE; ++i)
+                Insert(encoded.data(), i*width, width, bits[i] - *min);
+            count = for_words;
+        } else if (delta_words <= varint_words) {
+            block = {bits[0], offset, delta_width, Codec(BlockCodec::DeltaFrameOfReference)};
+            // The slot of the first element is left zero
+            encoded[0] = *min_delta;
+            for (size_t i = 1; i < BLOCK_SIZE; ++i)
+                Insert(encoded.data() + 1, i*delta_width, delta_width, deltas[i] - *min_delta);
+            count = delta_words;
+        } else {
+            block = {bits[0], offset, 0, Codec(BlockCodec::DeltaVarint)};
+            std::memcpy(encoded.data(), varints.data(), varint_bytes);
+            count = varint_words;
+        }
+
+        // Only the reservations can throw, before anything is appended
+        Grow(words_, count);
+        Grow(blocks_, 1);
+        words_.Append(std::span(encoded.data(), count));
+        blocks_.PushBack(block);
+    }
+
+    // Makes room for `count` more elements, growing geometrically so that
+    // appending block by block stays amortised O(1)
+    template <typename T>
+    static void Grow(Vector<T>& v, size_t count) {
+        if (v.Size() + count > v.Capacity())
+            v.Reserve(std::max(2*v.Capacity(), v.Size() + count));
+    }
+
+    static uint64_t Codec(BlockCodec codec) noexcept {
+        return static_cast<uint64_t>(codec);
+    }
+
+    // Writes `value` as `width` bits at bit `pos`, into zeroed words
+    static void Insert(uint64_t* words, size_t pos, size_t width, uint64_t value) noexcept {
+        if (!width)
+            return;
+        const size_t shift = pos % 64;
+        words[pos/64] |= value << shift;
+        if (shift + width > 64)
+            words[pos/64 + 1] |= value >> (64 - shift);
+    }
+
+    static uint64_t Zigzag(uint64_t delta) noexcept {
+        return delta << 1 ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+    }
+
+    static uint64_t Unzigzag(uint64_t value) noexcept {
+        return value >> 1 ^ (~(value & 1) + 1);
+    }
+
+    // Returns the new end
+    static size_t WriteVarint(uint64_t value, uint8_t* out, size_t pos) noexcept {
+        while (value >= 0x80) {
+            out[pos++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        out[pos++] = static_cast<uint8_t>(value);
+        return pos;
+    }
+
+    // ---------- Decoding ----------------
+
+    static uint64_t ReadVarint(const uint8_t*& in) noexcept {
+        uint64_t value = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            const uint8_t byte = *in++;
+            value |= uint64_t{byte & 0x7fu} << shift;
+            if (byte < 0x80)
+                return value;
+        }
+    }
+
+    static uint64_t Extract(const uint64_t* words, size_t pos, size_t width) noexcept {
+        if (!width)
+            return 0;
+        const size_t shift = pos % 64;
+        uint64_t value = words[pos/64] >> shift;
+        if (shift + width > 64)
+            value |= words[pos/64 + 1] << (64 - shift);
+        return width == 64 ? value : value & ((uint64_t{1} << width) - 1);
+    }
+
+    template <size_t Width>
+    static void Unpack(const uint64_t* in, uint64_t base, uint64_t* out) noexcept {
+        constexpr uint64_t MASK = Width == 64 ? ~uint64_t{0} : (uint64_t{1} << Width) - 1;
+        if constexpr (Width == 0) {
+            std::fill_n(out, BLOCK_SIZE, base);
+        } else {
+            // Every 64 elements take exactly Width words and the bit
+            // pattern repeats
+            for (size_t group = 0; group < BLOCK_SIZE/64; ++group, in += Width, out += 64) {
+                for (size_t i = 0; i < 64; ++i) {
+                    const size_t word = i*Width/64;
+                    const size_t shift = i*Width % 64;
+                    uint64_t value = in[word] >> shift;
+                    // Split in two shifts, each below 64 even where the
+                    // compiler sees this branch is never taken
+                    if (shift + Width > 64)
+                        value |= in[word + 1] << 1 << (63 - shift);
+                    out[i] = base + (value & MASK);
+                }
+            }
+        }
+    }
+
+    static const Unpacker* GetUnpackers() noexcept {
+        static constexpr auto UNPACKERS = []<size_t... Widths>(std::index_sequence<Widths...>) {
+            return std::array<Unpacker, sizeof...(Widths)>{&Unpack<Widths>...};
+        }(std::make_index_sequence<65>{});
+        return UNPACKERS.data();
+    }
+};
+
+} // namespace cstl
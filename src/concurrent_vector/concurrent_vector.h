@@ -0,0 +1,239 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "vector/uninitialized.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+// Append-only vector for many concurrent producers. Storage is a table of
+// segments of sizes F, F, 2F, 4F, ..., so growth adds a segment
+// and never moves existing elements: references stay valid and readers
+// never wait.
+//
+// PushBack/EmplaceBack/Append may be called from any number of threads; each
+// makes sure the segments for the next free slots exist, then claims them
+// with one compare-and-swap. Readers may access an element
+// once the call that appended it has returned (and that is visible to them,
+// e.g. via the returned index). Size() counts claimed slots, some of which
+// may still be under construction. Clear, Reserve and destruction must not
+// race with other calls.
+//
+// Elements are built before a slot is claimed unless that cannot throw, so
+// a failing constructor never leaves a hole; T must be nothrow movable
+// (allocator-aware T with an equal allocator). If a segment cannot be
+// allocated the call throws and appends nothing.
+template <typename T, size_t FirstSegmentSize = 64, typename Allocator = std::allocator<T>>
+class ConcurrentVector {
+    static_assert(std::has_single_bit(FirstSegmentSize),
+                  "first segment size must be a power of two");
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "elements are moved into their slots after construction");
+
+    static constexpr size_t FIRST_SEGMENT_BITS = std::countr_zero(FirstSegmentSize);
+    static constexpr size_t MAX_SEGMENTS = 64 - FIRST_SEGMENT_BITS + 1;
+
+    using Segment = RawMemory<T, Allocator>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+public:
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Allocator& alloc)
+            : alloc_(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        Clear();
+        for (size_t segment = 0; segment < MAX_SEGMENTS; ++segment)
+            if (segments_[segment].load(std::memory_order_relaxed))
+                std::destroy_at(&memory_[segment].value);
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        const size_t segment = SegmentOf(index);
+        return segments_[segment].load(std::memory_order_acquire)
+            [index - SegmentBase(segment)];
+    }
+
+    size_t Size() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    // Capacity of the segments allocated so far
+    size_t Capacity() const noexcept {
+        size_t segment = 0;
+        while (segment < MAX_SEGMENTS
+               && segments_[segment].load(std::memory_order_acquire))
+            ++segment;
+        return segment ? SegmentBase(segment) : 0;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Returns the index of the new element
+    template <typename... Args>
+    size_t EmplaceBack(Args&&... args) {
+        if constexpr (std::is_nothrow_constructible_v<T, Args...>) {
+            const size_t index = Claim(1);
+            detail::ConstructAt(alloc_, Slot(index), std::forward<Args>(args)...);
+            return index;
+        } else {
+            T tmp = std::make_obj_using_allocator<T>(alloc_, std::forward<Args>(args)...);
+            return EmplaceBack(std::move(tmp));
+        }
+    }
+
+    // Appends [first, last) as one contiguous run of indices and returns the
+    // index of its first element
+    template <std::forward_iterator ForwardIt>
+    size_t Append(ForwardIt first, ForwardIt last) {
+        if constexpr (!std::is_nothrow_constructible_v<T, decltype(*first)>) {
+            Vector<T, Allocator> tmp(alloc_);
+            tmp.Assign(first, last);
+            return AppendN(std::make_move_iterator(tmp.begin()), tmp.Size());
+        } else {
+            return AppendN(first, std::distance(first, last));
+        }
+    }
+
+    // Allocates the segments needed to hold `capacity` elements up front
+    void Reserve(size_t capacity) {
+        if (capacity)
+            for (size_t segment = 0; segment <= SegmentOf(capacity - 1); ++segment)
+                AcquireSegment(segment);
+    }
+
+    // Destroys the elements, keeping the segments
+    void Clear() noexcept {
+        const size_t size = size_.exchange(0, std::memory_order_acq_rel);
+        for (size_t segment = 0; segment < MAX_SEGMENTS; ++segment) {
+            const size_t base = SegmentBase(segment);
+            if (base >= size)
+                break;
+
+            detail::DestroyN(
+                alloc_,
+                segments_[segment].load(std::memory_order_relaxed),
+                std::min(size - base, SegmentSize(segment))
+            );
+        }
+    }
+
+private:
+    alignas(64) std::atomic<size_t> size_ = 0;
+    // Addresses of the segments built in memory_, published once they exist
+    alignas(64) std::array<std::atomic<T*>, MAX_SEGMENTS> segments_{};
+    std::array<std::atomic<bool>, MAX_SEGMENTS> allocating_{};
+    std::array<detail::Uninitialized<Segment>, MAX_SEGMENTS> memory_;
+    [[no_unique_address]] Allocator alloc_{};
+
+    static constexpr size_t SegmentOf(size_t index) noexcept {
+        return std::bit_width(index >> FIRST_SEGMENT_BITS);
+    }
+
+    static constexpr size_t SegmentBase(size_t segment) noexcept {
+        return segment ? FirstSegmentSize << (segment - 1) : 0;
+    }
+
+    static constexpr size_t SegmentSize(size_t segment) noexcept {
+        return segment ? SegmentBase(segment) : FirstSegmentSize;
+    }
+
+    // Claims `count` slots and builds them from `first` onwards, which must
+    // not throw
+    template <typename InputIt>
+    size_t AppendN(InputIt first, size_t count) {
+        const size_t start = Claim(count);
+        for (size_t index = start; index < start + count; ++first, ++index)
+            detail::ConstructAt(alloc_, Slot(index), *first);
+        return start;
+    }
+
+    // Returns the first of `count` newly claimed slots. Their segments are
+    // allocated before the claim, so if that throws nothing is claimed.
+    size_t Claim(size_t count) {
+        size_t start = size_.load(std::memory_order_relaxed);
+        do {
+            for (size_t segment = SegmentOf(start);
+                 SegmentBase(segment) < start + count;
+                 ++segment)
+                AcquireSegment(segment);
+        } while (!size_.compare_exchange_weak(start, start + count, std::memory_order_relaxed));
+        return start;
+    }
+
+    // Raw memory for a claimed index, whose segment exists
+    T* Slot(size_t index) noexcept {
+        const size_t segment = SegmentOf(index);
+        T* data = segments_[segment].load(std::memory_order_acquire);
+        assert(data);
+        return data + (index - SegmentBase(segment));
+    }
+
+    // Returns the segment, allocating it from alloc_ if no other thread
+    // does. Writers racing for the same new segment wait for its single
+    // allocation (never for a copy); readers only touch segments that
+    // already exist. If the allocation throws, the next writer tries again.
+    T* AcquireSegment(size_t segment) {
+        for (;;) {
+            T* data = segments_[segment].load(std::memory_order_acquire);
+            if (data)
+                return data;
+
+            if (!allocating_[segment].exchange(true, std::memory_order_acq_rel)) {
+                // Another writer may have finished between the two loads
+                data = segments_[segment].load(std::memory_order_acquire);
+                try {
+                    if (!data) {
+                        data = std::construct_at(&memory_[segment].value,
+                                                 SegmentSize(segment), alloc_)
+                            ->GetAddress();
+                        segments_[segment].store(data, std::memory_order_release);
+                    }
+                } catch (...) {
+                    ReleaseAllocating(segment);
+                    throw;
+                }
+                ReleaseAllocating(segment);
+                return data;
+            }
+
+            allocating_[segment].wait(true, std::memory_order_acquire);
+        }
+    }
+
+    void ReleaseAllocating(size_t segment) noexcept {
+        allocating_[segment].store(false, std::memory_order_release);
+        allocating_[segment].notify_all();
+    }
+};
+
+} // namespace cstl
@@ -0,0 +1,319 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "flat_map/search.h"
+#include "vector/index_iterator.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+// Map kept as two parallel Vectors, sorted unique keys and their values.
+// Lookups binary search the key array alone, so the values never come into
+// the cache until one is found. Inserting or erasing one entry shifts the
+// entries after it, so fill it in bulk (the constructor or InsertBatch)
+// where possible.
+//
+// Iterators yield a std::pair<const Key&, Value&> proxy. Of several entries
+// with equivalent keys the first one inserted is kept.
+template <typename Key,
+          typename Value,
+          typename Compare = std::less<Key>,
+          typename KeyAllocator = std::allocator<Key>,
+          typename ValueAllocator = std::allocator<Value>>
+class FlatMap {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using key_compare = Compare;
+    using key_container_type = Vector<Key, KeyAllocator>;
+    using mapped_container_type = Vector<Value, ValueAllocator>;
+
+private:
+    template <bool IsConst>
+    struct IteratorAccess {
+        using Container = FlatMap;
+        using Handle = std::conditional_t<IsConst, const FlatMap*, FlatMap*>;
+        using value_type = std::pair<Key, Value>;
+        using reference = std::pair<
+            const Key&,
+            std::conditional_t<IsConst, const Value&, Value&>
+        >;
+        using pointer = detail::ArrowProxy<reference>;
+
+        static reference Get(Handle map, size_t index) noexcept {
+            return {map->keys_[index], map->values_[index]};
+        }
+    };
+
+public:
+    using iterator = detail::IndexIterator<IteratorAccess, false>;
+    using const_iterator = detail::IndexIterator<IteratorAccess, true>;
+
+public:
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp)
+            : comp_(comp) {
+    }
+
+    // Sorts the entries once, by key, and drops duplicate keys. `values[i]`
+    // belongs to `keys[i]`.
+    FlatMap(key_container_type keys, mapped_container_type values,
+            const Compare& comp = Compare())
+            : keys_(std::move(keys))
+            , values_(std::move(values))
+            , comp_(comp) {
+        assert(keys_.Size() == values_.Size());
+        SortUnique(keys_, values_);
+    }
+
+    template <std::input_iterator InputIt>
+    FlatMap(InputIt first, InputIt last, const Compare& comp = Compare())
+            : FlatMap(comp) {
+        for (; first != last; ++first) {
+            keys_.EmplaceBack(first->first);
+            values_.EmplaceBack(first->second);
+        }
+        SortUnique(keys_, values_);
+    }
+
+    FlatMap(std::initializer_list<std::pair<Key, Value>> entries,
+            const Compare& comp = Compare())
+            : FlatMap(entries.begin(), entries.end(), comp) {
+    }
+
+    // Throws std::out_of_range if there is no such key
+    const Value& At(const Key& key) const {
+        return const_cast<FlatMap&>(*this).At(key);
+    }
+
+    Value& At(const Key& key) {
+        const size_t index = IndexOf(key);
+        if (index == Size())
+            throw std::out_of_range("FlatMap::At: no such key");
+        return values_[index];
+    }
+
+    // Inserts a value-initialised entry if there is no such key
+    Value& operator[](const Key& key) {
+        return TryEmplace(key).first->second;
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, Size()};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, Size()};
+    }
+
+    // The sorted keys, and the values in the same order
+    const key_container_type& Keys() const noexcept {
+        return keys_;
+    }
+
+    const mapped_container_type& Values() const noexcept {
+        return values_;
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+        values_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+    }
+
+    void Swap(FlatMap& other) noexcept {
+        keys_.Swap(other.keys_);
+        values_.Swap(other.values_);
+        std::swap(comp_, other.comp_);
+    }
+
+    // First entry whose key is not ordered before `key`
+    iterator LowerBound(const Key& key) {
+        return {this, LowerBoundIndex(key)};
+    }
+
+    const_iterator LowerBound(const Key& key) const {
+        return {this, LowerBoundIndex(key)};
+    }
+
+    iterator Find(const Key& key) {
+        return {this, IndexOf(key)};
+    }
+
+    const_iterator Find(const Key& key) const {
+        return {this, IndexOf(key)};
+    }
+
+    bool Contains(const Key& key) const {
+        return IndexOf(key) != Size();
+    }
+
+    // Returns the entry and whether it was inserted; an existing value is
+    // left unchanged
+    std::pair<iterator, bool> Insert(const Key& key, const Value& value) {
+        return TryEmplace(key, value);
+    }
+
+    std::pair<iterator, bool> Insert(const Key& key, Value&& value) {
+        return TryEmplace(key, std::move(value));
+    }
+
+    // Constructs the value from `args` only if there is no such key
+    template <typename... Args>
+    std::pair<iterator, bool> TryEmplace(const Key& key, Args&&... args) {
+        const size_t index = LowerBoundIndex(key);
+        if (index != Size() && !comp_(key, keys_[index]))
+            return {{this, index}, false};
+
+        values_.Emplace(values_.begin() + index, std::forward<Args>(args)...);
+        try {
+            keys_.Emplace(keys_.begin() + index, key);
+        } catch (...) {
+            values_.Erase(values_.begin() + index);
+            throw;
+        }
+        return {{this, index}, true};
+    }
+
+    // Inserts a range of (key, value) pairs: they are sorted among
+    // themselves, then the two sorted runs are merged into new arrays in one
+    // pass. O((n + m) + m log m) instead of m shifting insertions. Existing
+    // values are left unchanged.
+    template <typename Range>
+    void InsertBatch(Range&& range) {
+        FlatMap batch(std::begin(range), std::end(range), comp_);
+        if (!batch.Size())
+            return;
+
+        key_container_type keys(keys_.GetAllocator());
+        mapped_container_type values(values_.GetAllocator());
+        keys.Reserve(Size() + batch.Size());
+        values.Reserve(Size() + batch.Size());
+
+        size_t i = 0;
+        size_t j = 0;
+        while (i < Size() || j < batch.Size()) {
+            if (j == batch.Size() || (i < Size() && !comp_(batch.keys_[j], keys_[i]))) {
+                // Equivalent keys: keep ours, skip theirs
+                if (j < batch.Size() && !comp_(keys_[i], batch.keys_[j]))
+                    ++j;
+                keys.EmplaceBack(std::move(keys_[i]));
+                values.EmplaceBack(std::move(values_[i]));
+                ++i;
+            } else {
+                keys.EmplaceBack(std::move(batch.keys_[j]));
+                values.EmplaceBack(std::move(batch.values_[j]));
+                ++j;
+            }
+        }
+        keys_.Swap(keys);
+        values_.Swap(values);
+    }
+
+    // Returns the number of entries erased, 0 or 1
+    size_t Erase(const Key& key) {
+        const size_t index = IndexOf(key);
+        if (index == Size())
+            return 0;
+        EraseAt(index);
+        return 1;
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(pos.handle_ == this && pos.index_ < Size());
+        EraseAt(pos.index_);
+        return {this, pos.index_};
+    }
+
+private:
+    key_container_type keys_;
+    mapped_container_type values_;
+    [[no_unique_address]] Compare comp_{};
+
+    size_t LowerBoundIndex(const Key& key) const {
+        return detail::LowerBound(keys_.begin(), keys_.Size(), key, comp_);
+    }
+
+    // Index of `key`, Size() if absent
+    size_t IndexOf(const Key& key) const {
+        const size_t index = LowerBoundIndex(key);
+        return index != Size() && !comp_(key, keys_[index]) ? index : Size();
+    }
+
+    void EraseAt(size_t index) {
+        keys_.Erase(keys_.begin() + index);
+        values_.Erase(values_.begin() + index);
+    }
+
+    // Sorts the entries by key, keeping equivalent keys in order, and keeps
+    // the first of each group. Entries are reordered through a sorted index
+    // permutation, so each key and value moves once.
+    void SortUnique(key_container_type& keys, mapped_container_type& values) {
+        const auto equivalent = [this](const Key& lhs, const Key& rhs) {
+            return !comp_(lhs, rhs);
+        };
+        if (std::adjacent_find(keys.begin(), keys.end(), equivalent) == keys.end())
+            return;
+
+        Vector<size_t> order(keys.Size());
+        for (size_t i = 0; i < order.Size(); ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+            return comp_(keys[lhs], keys[rhs]);
+        });
+        order.Erase(
+            std::unique(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+                return equivalent(keys[lhs], keys[rhs]);
+            }),
+            order.end()
+        );
+
+        key_container_type sorted_keys(keys.GetAllocator());
+        mapped_container_type sorted_values(values.GetAllocator());
+        sorted_keys.Reserve(order.Size());
+        sorted_values.Reserve(order.Size());
+        for (const size_t index : order) {
+            sorted_keys.EmplaceBack(std::move(keys[index]));
+            sorted_values.EmplaceBack(std::move(values[index]));
+        }
+        keys.Swap(sorted_keys);
+        values.Swap(sorted_values);
+    }
+};
+
+} // namespace cstl
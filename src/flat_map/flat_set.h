@@ -0,0 +1,173 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "flat_map/search.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+// Set kept as a sorted Vector of unique keys: lookups are a binary search
+// over one contiguous array, and there is no per-element node. Inserting or
+// erasing one key shifts the keys after it, so fill it in bulk (the
+// constructor or InsertBatch) where possible.
+//
+// Of several equivalent keys the first one inserted is kept.
+template <typename Key,
+          typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<Key>>
+class FlatSet {
+public:
+    using key_type = Key;
+    using value_type = Key;
+    using key_compare = Compare;
+    using container_type = Vector<Key, Allocator>;
+    using iterator = const Key*;
+    using const_iterator = const Key*;
+
+public:
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& comp)
+            : comp_(comp) {
+    }
+
+    // Sorts `keys` once and drops duplicates
+    explicit FlatSet(container_type keys, const Compare& comp = Compare())
+            : keys_(std::move(keys))
+            , comp_(comp) {
+        keys_.Erase(SortUnique(keys_.begin(), keys_.end()), keys_.end());
+    }
+
+    FlatSet(std::initializer_list<Key> keys, const Compare& comp = Compare())
+            : FlatSet(comp) {
+        keys_.Assign(keys);
+        keys_.Erase(SortUnique(keys_.begin(), keys_.end()), keys_.end());
+    }
+
+    iterator begin() const noexcept {
+        return keys_.begin();
+    }
+
+    iterator end() const noexcept {
+        return keys_.end();
+    }
+
+    iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    iterator cend() const noexcept {
+        return end();
+    }
+
+    const container_type& Keys() const noexcept {
+        return keys_;
+    }
+
+    size_t Size() const noexcept {
+        return keys_.Size();
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+    }
+
+    void Swap(FlatSet& other) noexcept {
+        keys_.Swap(other.keys_);
+        std::swap(comp_, other.comp_);
+    }
+
+    // First key not ordered before `key`
+    iterator LowerBound(const Key& key) const {
+        return begin() + detail::LowerBound(keys_.begin(), keys_.Size(), key, comp_);
+    }
+
+    iterator Find(const Key& key) const {
+        const iterator it = LowerBound(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    bool Contains(const Key& key) const {
+        return Find(key) != end();
+    }
+
+    // Returns the key and whether it was inserted
+    std::pair<iterator, bool> Insert(const Key& key) {
+        return InsertImpl(key);
+    }
+
+    std::pair<iterator, bool> Insert(Key&& key) {
+        return InsertImpl(std::move(key));
+    }
+
+    // Sorts the new keys among themselves, then merges the two sorted runs:
+    // O((n + m) + m log m) instead of m shifting insertions
+    template <typename Range>
+    void InsertBatch(Range&& range) {
+        const size_t old_size = keys_.Size();
+        keys_.Append(std::forward<Range>(range));
+
+        keys_.Erase(SortUnique(keys_.begin() + old_size, keys_.end()), keys_.end());
+
+        // Stable: of equivalent keys the older one comes first and is kept
+        std::inplace_merge(keys_.begin(), keys_.begin() + old_size, keys_.end(), comp_);
+        keys_.Erase(Unique(keys_.begin(), keys_.end()), keys_.end());
+    }
+
+    // Returns the number of keys erased, 0 or 1
+    size_t Erase(const Key& key) {
+        const iterator it = Find(key);
+        if (it == end())
+            return 0;
+        keys_.Erase(it);
+        return 1;
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(pos >= begin() && pos < end());
+        return keys_.Erase(pos);
+    }
+
+private:
+    container_type keys_;
+    [[no_unique_address]] Compare comp_{};
+
+    template <typename T>
+    std::pair<iterator, bool> InsertImpl(T&& key) {
+        const iterator it = LowerBound(key);
+        if (it != end() && !comp_(key, *it))
+            return {it, false};
+        return {keys_.Insert(it, std::forward<T>(key)), true};
+    }
+
+    // Sorts [first, last) keeping equivalent keys in order, and moves the
+    // first of each group to the front; returns the end of those
+    Key* SortUnique(Key* first, Key* last) {
+        if (std::adjacent_find(first, last, [this](const Key& lhs, const Key& rhs) {
+                return !comp_(lhs, rhs);
+            }) == last) {
+            return last;
+        }
+        std::stable_sort(first, last, comp_);
+        return Unique(first, last);
+    }
+
+    Key* Unique(Key* first, Key* last) {
+        return std::unique(first, last, [this](const Key& lhs, const Key& rhs) {
+            return !comp_(lhs, rhs);
+        });
+    }
+};
+
+} // namespace cstl
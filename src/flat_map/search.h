@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+
+namespace cstl::detail {
+
+// Branchless lower bound over a sorted array: the loop runs ceil(log2(count))
+// times whatever the data, and each step picks the next base with a
+// conditional move rather than a branch, so there are no mispredictions. The
+// midpoints of both possible next steps are prefetched, which hides most of
+// the cache misses on arrays larger than the cache.
+template <typename T, typename Key, typename Compare>
+size_t LowerBound(const T* first, size_t count, const Key& key, const Compare& comp) {
+    if (!count)
+        return 0;
+
+    const T* base = first;
+    while (count > 1) {
+        const size_t half = count/2;
+        count -= half;
+#if defined(__GNUC__)
+        __builtin_prefetch(base + count/2);
+        __builtin_prefetch(base + half + count/2);
+#endif
+        base = comp(base[half], key) ? base + half : base;
+    }
+    return (base - first) + comp(*base, key);
+}
+
+} // namespace cstl::detail
@@ -0,0 +1,150 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) && !defined(CSTL_NO_SIMD)
+#include <emmintrin.h>
+#endif
+
+namespace cstl::detail {
+
+// Control bytes of a HashMap: one per slot, either a special value below or,
+// for a full slot, the 7 hash bits H2 of its key (0 ... 127)
+using Ctrl = int8_t;
+
+inline constexpr Ctrl CTRL_EMPTY = -128;   // 0b10000000
+inline constexpr Ctrl CTRL_DELETED = -2;   // 0b11111110
+inline constexpr Ctrl CTRL_SENTINEL = -1;  // 0b11111111, ends iteration
+
+inline constexpr bool IsFull(Ctrl ctrl) noexcept {
+    return ctrl >= 0;
+}
+
+inline constexpr bool IsEmptyOrDeleted(Ctrl ctrl) noexcept {
+    return ctrl < CTRL_SENTINEL;
+}
+
+// Bit i set for each matching byte i of a group; iterate with
+// `for (uint32_t i : mask)` from the lowest index
+class BitMask {
+public:
+    explicit constexpr BitMask(uint32_t mask) noexcept
+        : mask_(mask) {
+    }
+
+    constexpr explicit operator bool() const noexcept {
+        return mask_ != 0;
+    }
+
+    constexpr uint32_t LowestBit() const noexcept {
+        return std::countr_zero(mask_);
+    }
+
+    // Unset bits below the lowest set one, and above the highest set one of
+    // a 16-bit group mask
+    constexpr uint32_t TrailingZeros() const noexcept {
+        return std::countr_zero(mask_);
+    }
+
+    constexpr uint32_t LeadingZeros() const noexcept {
+        return std::countl_zero(mask_) - 16;
+    }
+
+    constexpr BitMask begin() const noexcept {
+        return *this;
+    }
+
+    constexpr BitMask end() const noexcept {
+        return BitMask(0);
+    }
+
+    constexpr uint32_t operator*() const noexcept {
+        return LowestBit();
+    }
+
+    constexpr BitMask& operator++() noexcept {
+        mask_ &= mask_ - 1;
+        return *this;
+    }
+
+    friend constexpr bool operator==(BitMask lhs, BitMask rhs) noexcept {
+        return lhs.mask_ == rhs.mask_;
+    }
+
+private:
+    uint32_t mask_;
+};
+
+// 16 control bytes compared one at a time; the fallback where SSE2 is not
+// available
+class ScalarGroup {
+public:
+    static constexpr size_t WIDTH = 16;
+
+    explicit ScalarGroup(const Ctrl* ctrl) noexcept {
+        std::memcpy(ctrl_, ctrl, WIDTH);
+    }
+
+    BitMask Match(Ctrl h2) const noexcept {
+        return MaskIf([h2](Ctrl ctrl) { return ctrl == h2; });
+    }
+
+    BitMask MatchEmpty() const noexcept {
+        return MaskIf([](Ctrl ctrl) { return ctrl == CTRL_EMPTY; });
+    }
+
+    BitMask MatchEmptyOrDeleted() const noexcept {
+        return MaskIf([](Ctrl ctrl) { return IsEmptyOrDeleted(ctrl); });
+    }
+
+private:
+    Ctrl ctrl_[WIDTH];
+
+    template <typename Predicate>
+    BitMask MaskIf(Predicate pred) const noexcept {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < WIDTH; ++i)
+            mask |= uint32_t{pred(ctrl_[i])} << i;
+        return BitMask(mask);
+    }
+};
+
+#if defined(__SSE2__) && !defined(CSTL_NO_SIMD)
+
+// 16 control bytes compared at once: one load, one compare, one movemask
+class Sse2Group {
+public:
+    static constexpr size_t WIDTH = 16;
+
+    explicit Sse2Group(const Ctrl* ctrl) noexcept
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {
+    }
+
+    BitMask Match(Ctrl h2) const noexcept {
+        return BitMask(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+    }
+
+    BitMask MatchEmpty() const noexcept {
+        return Match(CTRL_EMPTY);
+    }
+
+    // Empty and deleted are the only values below the sentinel
+    BitMask MatchEmptyOrDeleted() const noexcept {
+        return BitMask(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(CTRL_SENTINEL), ctrl_)));
+    }
+
+private:
+    __m128i ctrl_;
+};
+
+using Group = Sse2Group;
+
+#else
+
+using Group = ScalarGroup;
+
+#endif
+
+} // namespace cstl::detail
@@ -0,0 +1,679 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "hash_map/group.h"
+#include "vector/uninitialized.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+namespace detail {
+
+// Lookup key type: any K if both the hasher and the equality are
+// transparent, otherwise the key type itself
+template <bool Transparent>
+struct KeyArg {
+    template <typename K, typename Key>
+    using type = K;
+};
+
+template <>
+struct KeyArg<false> {
+    template <typename K, typename Key>
+    using type = Key;
+};
+
+} // namespace detail
+
+// Open-addressing hash map in the Swiss table layout. Slots live in one
+// RawMemory and, in another, one control byte per slot: empty, deleted, or 7
+// bits (H2) of the hash of the key stored there. The other bits (H1) pick
+// where probing starts. A lookup loads 16 control bytes at a time, compares
+// all of them to H2 with SSE2 (or a scalar loop where it is missing) and
+// checks only the slots that match, which are nearly always the right one.
+// The control array is followed by a sentinel that ends iteration and a
+// copy of its first 15 bytes, so a group can be loaded at any slot.
+//
+// The capacity is 2^k - 1 slots, at most 7/8 of them full. Insertion may
+// rehash, which invalidates iterators and references; Reserve first to
+// avoid it. Erasing leaves a tombstone unless no probe can have passed the
+// slot, and tombstones are dropped on the next rehash.
+//
+// Std integer hashes are often the identity, so the hash is mixed before it
+// is split into H1 and H2.
+template <typename Key,
+          typename Value,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, Value>>>
+class HashMap {
+    using Ctrl = detail::Ctrl;
+    using Group = detail::Group;
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using CtrlAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Ctrl>;
+    using HashAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<size_t>;
+
+    static constexpr size_t WIDTH = Group::WIDTH;
+    static constexpr size_t MIN_CAPACITY = WIDTH - 1;
+
+    // Elements are moved to a new table with memcpy
+    static constexpr bool RELOCATABLE
+        = is_trivially_relocatable_v<Key> && is_trivially_relocatable_v<Value>;
+
+    static constexpr bool TRANSPARENT
+        = requires { typename Hash::is_transparent; typename KeyEqual::is_transparent; };
+
+    template <typename K>
+    using key_arg = typename detail::KeyArg<TRANSPARENT>::template type<K, Key>;
+
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<const Key, Value>;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = Allocator;
+
+    template <bool IsConst>
+    class BasicIterator {
+        friend class HashMap;
+
+        using Slot = std::conditional_t<
+            IsConst,
+            const HashMap::value_type,
+            HashMap::value_type
+        >;
+
+        BasicIterator(const Ctrl* ctrl, Slot* slot) noexcept
+            : ctrl_(ctrl)
+            , slot_(slot)
+        {
+        }
+
+        // Moves to the first full slot from here on, or to the sentinel
+        void SkipFree() noexcept {
+            while (detail::IsEmptyOrDeleted(*ctrl_)) {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = HashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Slot*;
+        using reference = Slot&;
+
+        BasicIterator() = default;
+
+        BasicIterator(const BasicIterator&) = default;
+
+        BasicIterator(const BasicIterator<false>& other) noexcept
+        requires (IsConst)
+            : ctrl_(other.ctrl_)
+            , slot_(other.slot_)
+        {
+        }
+
+        BasicIterator& operator=(const BasicIterator&) = default;
+
+        [[nodiscard]] reference operator*() const noexcept {
+            return *slot_;
+        }
+
+        [[nodiscard]] pointer operator->() const noexcept {
+            return slot_;
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++ctrl_;
+            ++slot_;
+            SkipFree();
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator old_value(*this);
+            ++*this;
+            return old_value;
+        }
+
+        [[nodiscard]] friend bool operator==(const BasicIterator& lhs,
+                                             const BasicIterator& rhs) noexcept {
+            return lhs.ctrl_ == rhs.ctrl_;
+        }
+
+    private:
+        const Ctrl* ctrl_ = nullptr;
+        Slot* slot_ = nullptr;
+
+        friend class BasicIterator<!IsConst>;
+    };
+
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+public:
+    HashMap() = default;
+
+    explicit HashMap(const Allocator& alloc) noexcept
+            : ctrl_(CtrlAllocator(alloc))
+            , slots_(alloc) {
+    }
+
+    HashMap(std::initializer_list<value_type> values, const Allocator& alloc = Allocator())
+            : HashMap(alloc) {
+        Reserve(values.size());
+        for (const value_type& value : values)
+            Insert(value);
+    }
+
+    HashMap(const HashMap& other)
+            : HashMap(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    HashMap(const HashMap& other, const Allocator& alloc)
+            : HashMap(alloc) {
+        hash_ = other.hash_;
+        eq_ = other.eq_;
+        Reserve(other.size_);
+        for (const value_type& value : other)
+            InsertNew(HashOf(value.first), value);
+    }
+
+    HashMap(HashMap&& other) noexcept
+            : ctrl_(std::move(other.ctrl_))
+            , slots_(std::move(other.slots_))
+            , capacity_(std::exchange(other.capacity_, 0))
+            , size_(std::exchange(other.size_, 0))
+            , growth_left_(std::exchange(other.growth_left_, 0))
+            , hash_(std::move(other.hash_))
+            , eq_(std::move(other.eq_)) {
+    }
+
+    // Takes over the tables if `alloc` equals the allocator of `other`,
+    // otherwise moves the elements one by one
+    HashMap(HashMap&& other, const Allocator& alloc)
+            : HashMap(alloc) {
+        if (GetAllocator() == other.GetAllocator()) {
+            Swap(other);
+            return;
+        }
+
+        hash_ = other.hash_;
+        eq_ = other.eq_;
+        Reserve(other.size_);
+        for (value_type& value : other)
+            InsertNew(HashOf(value.first), std::move(value));
+    }
+
+    ~HashMap() {
+        DestroyAll();
+    }
+
+    HashMap& operator=(const HashMap& rhs) {
+        if (this == &rhs)
+            return *this;
+
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            if (GetAllocator() != rhs.GetAllocator()) {
+                DestroyAll();
+                size_ = capacity_ = growth_left_ = 0;
+                ctrl_.Reset(CtrlAllocator(rhs.GetAllocator()));
+                slots_.Reset(rhs.GetAllocator());
+            }
+        }
+
+        HashMap tmp(rhs, GetAllocator());
+        Swap(tmp);
+        return *this;
+    }
+
+    HashMap& operator=(HashMap&& rhs) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value
+        || AllocTraits::is_always_equal::value
+    ) {
+        if (this == &rhs)
+            return *this;
+
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            DestroyAll();
+            ctrl_ = std::move(rhs.ctrl_);
+            slots_ = std::move(rhs.slots_);
+            capacity_ = std::exchange(rhs.capacity_, 0);
+            size_ = std::exchange(rhs.size_, 0);
+            growth_left_ = std::exchange(rhs.growth_left_, 0);
+            hash_ = std::move(rhs.hash_);
+            eq_ = std::move(rhs.eq_);
+        } else if (GetAllocator() == rhs.GetAllocator()) {
+            Swap(rhs);
+        } else {
+            HashMap tmp(std::move(rhs), GetAllocator());
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    iterator begin() noexcept {
+        if (!size_)
+            return end();
+        iterator it(ctrl_.GetAddress(), slots_.GetAddress());
+        it.SkipFree();
+        return it;
+    }
+
+    iterator end() noexcept {
+        return {ctrl_.GetAddress() + capacity_, nullptr};
+    }
+
+    const_iterator begin() const noexcept {
+        return const_cast<HashMap&>(*this).begin();
+    }
+
+    const_iterator end() const noexcept {
+        return const_cast<HashMap&>(*this).end();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    void Swap(HashMap& other) noexcept {
+        ctrl_.Swap(other.ctrl_);
+        slots_.Swap(other.slots_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(growth_left_, other.growth_left_);
+        std::swap(hash_, other.hash_);
+        std::swap(eq_, other.eq_);
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return slots_.GetAllocator();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    // Number of slots, of which at most 7/8 are used
+    size_t Capacity() const noexcept {
+        return capacity_;
+    }
+
+    // Makes room for `count` elements in total without rehashing
+    void Reserve(size_t count) {
+        if (count > size_ + growth_left_)
+            Rehash(std::max(CapacityFor(count), capacity_));
+    }
+
+    // Destroys the elements, keeping the tables
+    void Clear() noexcept {
+        DestroyAll();
+        size_ = 0;
+        ResetCtrl();
+    }
+
+    template <typename K = Key>
+    iterator Find(const key_arg<K>& key) {
+        const size_t index = IndexOf(key, HashOf(key));
+        return index == capacity_ ? end() : IteratorAt(index);
+    }
+
+    template <typename K = Key>
+    const_iterator Find(const key_arg<K>& key) const {
+        return const_cast<HashMap&>(*this).Find(key);
+    }
+
+    template <typename K = Key>
+    bool Contains(const key_arg<K>& key) const {
+        return IndexOf(key, HashOf(key)) != capacity_;
+    }
+
+    // Throws std::out_of_range if there is no such key
+    template <typename K = Key>
+    Value& At(const key_arg<K>& key) {
+        const size_t index = IndexOf(key, HashOf(key));
+        if (index == capacity_)
+            throw std::out_of_range("HashMap::At: no such key");
+        return slots_[index].second;
+    }
+
+    template <typename K = Key>
+    const Value& At(const key_arg<K>& key) const {
+        return const_cast<HashMap&>(*this).At(key);
+    }
+
+    // Inserts a value-initialised entry if there is no such key
+    Value& operator[](const Key& key) {
+        return TryEmplace(key).first->second;
+    }
+
+    Value& operator[](Key&& key) {
+        return TryEmplace(std::move(key)).first->second;
+    }
+
+    // Returns the entry and whether it was inserted; an existing value is
+    // left unchanged
+    std::pair<iterator, bool> Insert(const value_type& value) {
+        return TryEmplace(value.first, value.second);
+    }
+
+    // Constructs the value from `args` only if there is no such key
+    template <typename... Args>
+    std::pair<iterator, bool> TryEmplace(const Key& key, Args&&... args) {
+        return TryEmplaceImpl(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> TryEmplace(Key&& key, Args&&... args) {
+        return TryEmplaceImpl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // Returns the number of entries erased, 0 or 1
+    template <typename K = Key>
+    size_t Erase(const key_arg<K>& key) {
+        const size_t index = IndexOf(key, HashOf(key));
+        if (index == capacity_)
+            return 0;
+        EraseAt(index);
+        return 1;
+    }
+
+    // Returns the entry after `pos`
+    iterator Erase(const_iterator pos) {
+        assert(pos != cend());
+        const size_t index = pos.ctrl_ - ctrl_.GetAddress();
+        EraseAt(index);
+
+        iterator next = IteratorAt(index);
+        ++next;
+        return next;
+    }
+
+    // An exact match for iterators, which the key overload would otherwise
+    // take on a map with transparent hash and equality
+    iterator Erase(iterator pos) {
+        return Erase(const_iterator(pos));
+    }
+
+private:
+    RawMemory<Ctrl, CtrlAllocator> ctrl_;
+    RawMemory<value_type, Allocator> slots_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    // Empty slots that may still be filled before the table is rehashed
+    size_t growth_left_ = 0;
+    [[no_unique_address]] Hash hash_{};
+    [[no_unique_address]] KeyEqual eq_{};
+
+    // ---------- Hashing -----------------
+
+    template <typename K>
+    size_t HashOf(const K& key) const {
+        // The 64-bit finaliser of MurmurHash3
+        uint64_t hash = hash_(key);
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return static_cast<size_t>(hash);
+    }
+
+    static size_t H1(size_t hash) noexcept {
+        return hash >> 7;
+    }
+
+    static Ctrl H2(size_t hash) noexcept {
+        return static_cast<Ctrl>(hash & 0x7f);
+    }
+
+    // ---------- Capacity ----------------
+
+    // Elements a table of `capacity` slots holds before it is rehashed
+    static size_t MaxSizeFor(size_t capacity) noexcept {
+        return capacity - capacity/8;
+    }
+
+    // Smallest 2^k - 1 capacity holding `count` elements
+    static size_t CapacityFor(size_t count) noexcept {
+        if (!count)
+            return 0;
+        const size_t capacity = std::bit_ceil(count + (count - 1)/7 + 1) - 1;
+        return std::max(capacity, MIN_CAPACITY);
+    }
+
+    // ---------- Probing -----------------
+
+    // Index of `key`, capacity_ if absent. Groups are visited at
+    // triangular offsets, which covers the whole table.
+    template <typename K>
+    size_t IndexOf(const K& key, size_t hash) const {
+        if (!capacity_)
+            return capacity_;
+
+        size_t offset = H1(hash) & capacity_;
+        for (size_t step = WIDTH;; step += WIDTH) {
+            const Group group(ctrl_ + offset);
+            for (const uint32_t i : group.Match(H2(hash))) {
+                const size_t index = (offset + i) & capacity_;
+                if (eq_(slots_[index].first, key)) [[likely]]
+                    return index;
+            }
+            // Insertion would have used that slot, so the key is not further
+            if (group.MatchEmpty())
+                return capacity_;
+            offset = (offset + step) & capacity_;
+        }
+    }
+
+    // First empty or deleted slot on the probe sequence of `hash`; the load
+    // limit guarantees there is one
+    size_t FreeIndex(size_t hash) const noexcept {
+        size_t offset = H1(hash) & capacity_;
+        for (size_t step = WIDTH;; step += WIDTH) {
+            if (const auto free = Group(ctrl_ + offset).MatchEmptyOrDeleted())
+                return (offset + free.LowestBit()) & capacity_;
+            offset = (offset + step) & capacity_;
+        }
+    }
+
+    // ---------- Control bytes -----------
+
+    // Also writes the copy of the first WIDTH - 1 bytes after the sentinel
+    void SetCtrl(size_t index, Ctrl value) noexcept {
+        ctrl_[index] = value;
+        ctrl_[((index - (WIDTH - 1)) & capacity_) + (WIDTH - 1)] = value;
+    }
+
+    void ResetCtrl() noexcept {
+        if (!capacity_)
+            return;
+        std::memset(ctrl_.GetAddress(), detail::CTRL_EMPTY, capacity_ + WIDTH);
+        ctrl_[capacity_] = detail::CTRL_SENTINEL;
+        growth_left_ = MaxSizeFor(capacity_) - size_;
+    }
+
+    // ---------- Modifiers ---------------
+
+    iterator IteratorAt(size_t index) noexcept {
+        return {ctrl_ + index, slots_ + index};
+    }
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> TryEmplaceImpl(K&& key, Args&&... args) {
+        const size_t hash = HashOf(key);
+        const size_t index = IndexOf(key, hash);
+        if (index != capacity_)
+            return {IteratorAt(index), false};
+
+        return {
+            InsertNew(
+                hash,
+                std::piecewise_construct,
+                std::forward_as_tuple(std::forward<K>(key)),
+                std::forward_as_tuple(std::forward<Args>(args)...)
+            ),
+            true
+        };
+    }
+
+    // Constructs an element whose key is known to be absent
+    template <typename... Args>
+    iterator InsertNew(size_t hash, Args&&... args) {
+        size_t index = capacity_ ? FreeIndex(hash) : 0;
+        if (!growth_left_ && (!capacity_ || ctrl_[index] != detail::CTRL_DELETED)) {
+            // Built before the table moves: args may refer to its elements
+            detail::Uninitialized<value_type> tmp;
+            std::construct_at(&tmp.value, std::forward<Args>(args)...);
+            try {
+                Rehash(GrownCapacity());
+            } catch (...) {
+                std::destroy_at(&tmp.value);
+                throw;
+            }
+
+            index = FreeIndex(hash);
+            if constexpr (RELOCATABLE) {
+                detail::Relocate(&tmp.value, 1, slots_ + index);
+            } else {
+                try {
+                    std::construct_at(slots_ + index, std::move_if_noexcept(tmp.value));
+                } catch (...) {
+                    std::destroy_at(&tmp.value);
+                    throw;
+                }
+                std::destroy_at(&tmp.value);
+            }
+        } else {
+            std::construct_at(slots_ + index, std::forward<Args>(args)...);
+        }
+
+        growth_left_ -= ctrl_[index] == detail::CTRL_EMPTY;
+        SetCtrl(index, H2(hash));
+        ++size_;
+        return IteratorAt(index);
+    }
+
+    // A full table of mostly tombstones is rehashed in place, otherwise it
+    // doubles
+    size_t GrownCapacity() const noexcept {
+        if (!capacity_)
+            return MIN_CAPACITY;
+        if (size_*32 <= capacity_*25)
+            return capacity_;
+        return capacity_*2 + 1;
+    }
+
+    // The slot becomes empty again rather than a tombstone if some window of
+    // WIDTH slots around it always had an empty slot: then no probe for
+    // another key went past it
+    void EraseAt(size_t index) noexcept {
+        std::destroy_at(slots_ + index);
+        --size_;
+
+        const auto empty_after = Group(ctrl_ + index).MatchEmpty();
+        const auto empty_before = Group(ctrl_ + ((index - WIDTH) & capacity_)).MatchEmpty();
+        const bool was_never_full = empty_before && empty_after
+            && empty_after.TrailingZeros() + empty_before.LeadingZeros() < WIDTH;
+
+        if (was_never_full) {
+            SetCtrl(index, detail::CTRL_EMPTY);
+            ++growth_left_;
+        } else {
+            SetCtrl(index, detail::CTRL_DELETED);
+        }
+    }
+
+    // Moves every element into new tables of `new_capacity` slots. Elements
+    // that cannot be relocated with memcpy are moved if that cannot throw
+    // and copied otherwise; their hashes are all taken before the first one
+    // moves, so if hashing, allocation or a copy throws the map is left
+    // unchanged. The memcpy path hashes as it goes and assumes hashing does
+    // not throw.
+    void Rehash(size_t new_capacity) {
+        RawMemory<size_t, HashAllocator> hashes(RELOCATABLE ? 0 : size_,
+                                                HashAllocator(slots_.GetAllocator()));
+        if constexpr (!RELOCATABLE) {
+            size_t k = 0;
+            for (size_t i = 0; i < capacity_; ++i) {
+                if (detail::IsFull(ctrl_[i]))
+                    hashes[k++] = HashOf(slots_[i].first);
+            }
+        }
+
+        // Swapped in below; from then on these hold the old tables
+        RawMemory<Ctrl, CtrlAllocator> old_ctrl(new_capacity + WIDTH, ctrl_.GetAllocator());
+        RawMemory<value_type, Allocator> old_slots(new_capacity, slots_.GetAllocator());
+        ctrl_.Swap(old_ctrl);
+        slots_.Swap(old_slots);
+        const size_t old_capacity = std::exchange(capacity_, new_capacity);
+        const size_t old_growth_left = growth_left_;
+        ResetCtrl();
+
+        const auto for_each_old = [&](auto fn) {
+            for (size_t i = 0; i < old_capacity; ++i) {
+                if (detail::IsFull(old_ctrl[i]))
+                    fn(old_slots[i]);
+            }
+        };
+
+        if constexpr (RELOCATABLE) {
+            for_each_old([this](value_type& value) {
+                const size_t hash = HashOf(value.first);
+                const size_t index = FreeIndex(hash);
+                detail::Relocate(&value, 1, slots_ + index);
+                SetCtrl(index, H2(hash));
+            });
+        } else {
+            try {
+                size_t k = 0;
+                for_each_old([this, &hashes, &k](value_type& value) {
+                    const size_t hash = hashes[k++];
+                    const size_t index = FreeIndex(hash);
+                    std::construct_at(slots_ + index, std::move_if_noexcept(value));
+                    SetCtrl(index, H2(hash));
+                });
+            } catch (...) {
+                DestroyAll();
+                ctrl_.Swap(old_ctrl);
+                slots_.Swap(old_slots);
+                capacity_ = old_capacity;
+                growth_left_ = old_growth_left;
+                throw;
+            }
+            for_each_old([](value_type& value) { std::destroy_at(&value); });
+        }
+        growth_left_ = MaxSizeFor(capacity_) - size_;
+    }
+
+    void DestroyAll() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<value_type>) {
+            for (size_t i = 0; i < capacity_; ++i) {
+                if (detail::IsFull(ctrl_[i]))
+                    std::destroy_at(slots_ + i);
+            }
+        }
+    }
+};
+
+} // namespace cstl
@@ -0,0 +1,341 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "instrumentation/instrumentation.h"
+#include "vector/growth_policy.h"
+#include "vector/index_iterator.h"
+#include "vector/uninitialized.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+// Vector with amortised reallocation for latency-bound callers. Growing
+// allocates the new buffer but leaves the elements in the old one; each
+// following mutating operation then relocates at most MigrationStep of them,
+// from the back. While both buffers are live, elements below pending_ are in
+// the old buffer and the others in the new one, so indexing costs one extra
+// comparison. With a growth factor of at least 1 + 1/MigrationStep the old
+// buffer is drained before the next growth, so no operation relocates more
+// than MigrationStep elements; otherwise growth first drains the rest.
+//
+// Element addresses change while migrating, iterators (an index) do not.
+template <typename T,
+          size_t MigrationStep = 16,
+          typename Allocator = std::allocator<T>,
+          typename GrowthPolicy = DoublingGrowth<>>
+class IncrementalVector {
+    static_assert(MigrationStep > 0, "migration step must be positive");
+    static_assert(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>,
+                  "migration runs inside operations that cannot roll it back");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Buffer = RawMemory<T, Allocator>;
+
+    template <bool IsConst>
+    struct IteratorAccess {
+        using Container = IncrementalVector;
+        using Handle = std::conditional_t<IsConst, const IncrementalVector*, IncrementalVector*>;
+        using value_type = T;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        static reference Get(Handle vector, size_t index) noexcept {
+            return (*vector)[index];
+        }
+    };
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using growth_policy = GrowthPolicy;
+    using iterator = detail::IndexIterator<IteratorAccess, false>;
+    using const_iterator = detail::IndexIterator<IteratorAccess, true>;
+
+    static constexpr size_t migration_step = MigrationStep;
+
+public:
+    IncrementalVector() = default;
+
+    explicit IncrementalVector(const Allocator& alloc) noexcept
+            : data_(alloc)
+            , old_(alloc) {
+    }
+
+    explicit IncrementalVector(const size_t size, const Allocator& alloc = Allocator())
+            : IncrementalVector(alloc) {
+        Resize(size);
+    }
+
+    IncrementalVector(const IncrementalVector& other)
+            : IncrementalVector(
+                other,
+                AllocTraits::select_on_container_copy_construction(other.GetAllocator())
+            ) {
+    }
+
+    IncrementalVector(const IncrementalVector& other, const Allocator& alloc)
+            : IncrementalVector(alloc) {
+        Reserve(other.size_);
+        for (const T& value : other)
+            EmplaceBack(value);
+    }
+
+    IncrementalVector(IncrementalVector&& other) noexcept
+            : data_(std::move(other.data_))
+            , old_(std::move(other.old_))
+            , size_(std::exchange(other.size_, 0))
+            , pending_(std::exchange(other.pending_, 0))
+            , growth_(std::move(other.growth_)) {
+    }
+
+    // Takes over the buffers of `other` if its allocator equals `alloc`,
+    // otherwise moves the elements one by one
+    IncrementalVector(IncrementalVector&& other, const Allocator& alloc)
+            : IncrementalVector(alloc) {
+        if (GetAllocator() == other.GetAllocator()) {
+            Swap(other);
+            return;
+        }
+
+        Reserve(other.size_);
+        for (T& value : other)
+            EmplaceBack(std::move(value));
+    }
+
+    ~IncrementalVector() {
+        Clear();
+        CSTL_INSTRUMENT(OnDeallocate, Capacity(), sizeof(T));
+    }
+
+    IncrementalVector& operator=(const IncrementalVector& rhs) {
+        if (this == &rhs)
+            return *this;
+
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            if (GetAllocator() != rhs.GetAllocator()) {
+                Clear();
+                CSTL_INSTRUMENT(OnDeallocate, Capacity(), sizeof(T));
+                data_.Reset(rhs.GetAllocator());
+                old_.Reset(rhs.GetAllocator());
+            }
+        }
+
+        IncrementalVector tmp(rhs, GetAllocator());
+        Swap(tmp);
+        return *this;
+    }
+
+    IncrementalVector& operator=(IncrementalVector&& rhs) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value
+        || AllocTraits::is_always_equal::value
+    ) {
+        if (this == &rhs)
+            return *this;
+
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            Clear();
+            CSTL_INSTRUMENT(OnDeallocate, Capacity(), sizeof(T));
+            data_ = std::move(rhs.data_);
+            old_ = std::move(rhs.old_);
+            size_ = std::exchange(rhs.size_, 0);
+            pending_ = std::exchange(rhs.pending_, 0);
+            growth_ = std::move(rhs.growth_);
+        } else if (GetAllocator() == rhs.GetAllocator()) {
+            Swap(rhs);
+        } else {
+            IncrementalVector tmp(std::move(rhs), GetAllocator());
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<IncrementalVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return index < pending_ ? old_[index] : data_[index];
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+    void Swap(IncrementalVector& other) noexcept {
+        data_.Swap(other.data_);
+        old_.Swap(other.old_);
+        std::swap(size_, other.size_);
+        std::swap(pending_, other.pending_);
+        std::swap(growth_, other.growth_);
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    // Capacity of the new buffer; the old one is released once drained
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    // Whether some elements still live in the previous buffer
+    bool IsMigrating() const noexcept {
+        return pending_ != 0;
+    }
+
+    // Relocates all pending elements now, e.g. before a latency-critical
+    // section
+    void FinishMigration() noexcept {
+        Migrate(pending_);
+    }
+
+    // Switches to a buffer of `new_capacity`; the elements follow gradually
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity())
+            return;
+
+        StartMigration(Buffer(new_capacity, GetAllocator()));
+        Migrate(MigrationStep);
+    }
+
+    void Resize(size_t new_size) {
+        Reserve(new_size);
+
+        while (size_ < new_size)
+            EmplaceBack();
+        while (size_ > new_size)
+            PopBack();
+    }
+
+    // Destroys the elements, keeping the newer buffer
+    void Clear() noexcept {
+        detail::DestroyN(Alloc(), old_.GetAddress(), pending_);
+        detail::DestroyN(Alloc(), data_ + pending_, size_ - pending_);
+        size_ = pending_ = 0;
+        ReleaseOld();
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            // Built before any element moves: args may refer to elements of
+            // *this
+            Buffer new_data(
+                growth_.NextCapacity(Capacity(), size_ + 1, sizeof(T)),
+                GetAllocator()
+            );
+            detail::ConstructAt(new_data.GetAllocator(), new_data + size_,
+                                std::forward<Args>(args)...);
+            StartMigration(std::move(new_data));
+        } else {
+            detail::ConstructAt(Alloc(), data_ + size_, std::forward<Args>(args)...);
+        }
+
+        T& element = data_[size_++];
+        Migrate(MigrationStep);
+        return element;
+    }
+
+    void PopBack() noexcept {
+        assert(size_);
+
+        --size_;
+        if (size_ < pending_) {
+            detail::DestroyAt(Alloc(), old_ + size_);
+            pending_ = size_;
+        } else {
+            detail::DestroyAt(Alloc(), data_ + size_);
+        }
+        Migrate(MigrationStep);
+    }
+
+private:
+    // Elements [0, pending_) are in old_, [pending_, size_) in data_
+    Buffer data_;
+    Buffer old_;
+    size_t size_ = 0;
+    size_t pending_ = 0;
+    [[no_unique_address]] GrowthPolicy growth_{};
+
+    Allocator& Alloc() noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Makes `new_data` current and leaves the elements in the previous
+    // buffer. A migration still running is completed first.
+    void StartMigration(Buffer&& new_data) noexcept {
+        FinishMigration();
+        CSTL_INSTRUMENT(OnReallocate, Capacity(), new_data.Capacity(), size_, sizeof(T));
+
+        old_.Swap(data_);
+        data_.Swap(new_data);
+        pending_ = size_;
+    }
+
+    // Relocates up to `count` of the last pending elements into data_
+    void Migrate(size_t count) noexcept {
+        count = std::min(count, pending_);
+        const size_t first = pending_ - count;
+
+        if constexpr (is_trivially_relocatable_v<T>) {
+            detail::Relocate(old_ + first, count, data_ + first);
+        } else {
+            detail::UninitializedMoveN(Alloc(), old_ + first, count, data_ + first);
+            detail::DestroyN(Alloc(), old_ + first, count);
+        }
+
+        pending_ = first;
+        if (!pending_)
+            ReleaseOld();
+    }
+
+    void ReleaseOld() noexcept {
+        if (!old_.Capacity())
+            return;
+
+        Buffer released(GetAllocator());
+        old_.Swap(released);
+    }
+};
+
+} // namespace cstl
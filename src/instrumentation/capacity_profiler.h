@@ -0,0 +1,186 @@
+#pragma once
+
+// Capacity profiling, compiled in only when CSTL_CAPACITY_PROFILING is
+// defined (before any cstl header is included). Each profiled container
+// remembers where it was constructed and how many times it reallocated; on
+// destruction it adds its final size to the statistics of that call site.
+// At exit the profiler prints a size histogram per site to stderr with the
+// Reserve() value that would have avoided growth for 90% of the instances.
+//
+// Constructors take the call site as a defaulted trailing parameter
+// (CSTL_SITE_PARAM), so the source_location is the caller's. Without
+// profiling the parameter and the probe member vanish.
+
+#include <cstddef>
+
+#if defined(CSTL_CAPACITY_PROFILING)
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#define CSTL_SITE_PARAM ::cstl::profiling::Site site = ::cstl::profiling::Site::current()
+#define CSTL_AND_SITE_PARAM , CSTL_SITE_PARAM
+#define CSTL_SITE site
+#define CSTL_AND_SITE , site
+// For containers built internally, which should not be profiled
+#define CSTL_AND_NO_SITE , ::cstl::profiling::Site{}
+
+namespace cstl::profiling {
+
+using Site = std::source_location;
+
+struct SiteStats {
+    uint64_t instances = 0;
+    uint64_t growth_steps = 0;
+    uint64_t max_size = 0;
+    // Instances by std::bit_width(final size): [0] holds empty ones, [k]
+    // sizes in [2^(k-1), 2^k)
+    std::array<uint64_t, 65> histogram{};
+
+    // Smallest capacity that fits the final size of 90% of the instances,
+    // rounded up to the end of its histogram bucket
+    size_t SuggestedReserve() const noexcept {
+        uint64_t covered = 0;
+        for (size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+            covered += histogram[bucket];
+            if (covered*10 >= instances*9)
+                return bucket
+                    ? std::min<uint64_t>(max_size, (uint64_t{1} << bucket) - 1)
+                    : 0;
+        }
+        return max_size;
+    }
+};
+
+class Profiler {
+public:
+    static Profiler& Instance() {
+        // Never destroyed: containers with static storage duration may
+        // still report after exit handlers run
+        static Profiler* profiler = [] {
+            std::atexit([] { Instance().Print(stderr); });
+            return new Profiler();
+        }();
+        return *profiler;
+    }
+
+    void Record(const Site& site, size_t final_size, size_t growth_steps) {
+        std::string key = std::string(site.file_name()) + ':'
+                          + std::to_string(site.line()) + " ("
+                          + site.function_name() + ')';
+
+        std::lock_guard lock(mutex_);
+        SiteStats& stats = sites_[std::move(key)];
+        ++stats.instances;
+        stats.growth_steps += growth_steps;
+        stats.max_size = std::max<uint64_t>(stats.max_size, final_size);
+        ++stats.histogram[std::bit_width(final_size)];
+    }
+
+    std::map<std::string, SiteStats> Snapshot() const {
+        std::lock_guard lock(mutex_);
+        return sites_;
+    }
+
+    void Reset() {
+        std::lock_guard lock(mutex_);
+        sites_.clear();
+    }
+
+    void Print(std::FILE* out) const {
+        for (const auto& [site, stats] : Snapshot()) {
+            std::fprintf(out, "%s\n  instances %llu, growth steps %llu, "
+                              "max size %llu, suggested Reserve(%zu)\n",
+                         site.c_str(),
+                         static_cast<unsigned long long>(stats.instances),
+                         static_cast<unsigned long long>(stats.growth_steps),
+                         static_cast<unsigned long long>(stats.max_size),
+                         stats.SuggestedReserve());
+
+            for (size_t bucket = 0; bucket < stats.histogram.size(); ++bucket) {
+                if (!stats.histogram[bucket])
+                    continue;
+                std::fprintf(out, "  size < %-20llu %llu\n",
+                             bucket < 64 ? 1ull << bucket : ~0ull,
+                             static_cast<unsigned long long>(stats.histogram[bucket]));
+            }
+        }
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, SiteStats> sites_;
+
+    Profiler() = default;
+};
+
+// Per-instance record kept by a profiled container. A probe built without a
+// site (or moved from) reports nothing.
+class CapacityProbe {
+public:
+    constexpr CapacityProbe() noexcept = default;
+
+    constexpr explicit CapacityProbe(const Site& site) noexcept
+        : site_(site)
+        , active_(site.line() != 0)
+    {
+    }
+
+    constexpr CapacityProbe(CapacityProbe&& other) noexcept
+        : site_(other.site_)
+        , growth_steps_(other.growth_steps_)
+        , active_(std::exchange(other.active_, false))
+    {
+    }
+
+    CapacityProbe& operator=(const CapacityProbe&) = delete;
+
+    constexpr void OnGrowth() noexcept {
+        ++growth_steps_;
+    }
+
+    constexpr void OnDestroy(size_t final_size) noexcept {
+        // Containers of constant evaluation are not profiled
+        if (!active_ || std::is_constant_evaluated())
+            return;
+
+        try {
+            Profiler::Instance().Record(site_, final_size, growth_steps_);
+        } catch (...) {
+            // Profiling is best effort
+        }
+    }
+
+private:
+    Site site_{};
+    size_t growth_steps_ = 0;
+    bool active_ = false;
+};
+
+} // namespace cstl::profiling
+
+#else
+#define CSTL_SITE_PARAM
+#define CSTL_AND_SITE_PARAM
+#define CSTL_SITE
+#define CSTL_AND_SITE
+#define CSTL_AND_NO_SITE
+
+namespace cstl::profiling {
+
+struct CapacityProbe {
+    constexpr void OnGrowth() noexcept {}
+    constexpr void OnDestroy(size_t) noexcept {}
+};
+
+} // namespace cstl::profiling
+#endif
@@ -0,0 +1,207 @@
+#pragma once
+
+// Allocation counters for the containers, compiled in only when
+// CSTL_INSTRUMENTATION is defined (before any cstl header is included).
+// Otherwise CSTL_INSTRUMENT expands to nothing and its arguments are not
+// evaluated.
+//
+// Containers report events with CSTL_INSTRUMENT(Event, args...) from their
+// member functions; each event updates the counters of the container type
+// and the global ones. instrumentation::DumpJson() writes all of them.
+
+#if defined(CSTL_INSTRUMENTATION)
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+// Events are not recorded in constant evaluation
+#define CSTL_INSTRUMENT(Event, ...)                                                  \
+    (std::is_constant_evaluated()                                                    \
+        ? static_cast<void>(0)                                                       \
+        : ::cstl::instrumentation::Event<std::remove_cvref_t<decltype(*this)>>(__VA_ARGS__))
+
+namespace cstl::instrumentation {
+
+struct Counters {
+    std::atomic<uint64_t> allocations = 0;
+    std::atomic<uint64_t> deallocations = 0;
+    std::atomic<uint64_t> bytes_allocated = 0;
+    std::atomic<uint64_t> reallocations = 0;
+    std::atomic<uint64_t> relocated_elements = 0;
+    std::atomic<uint64_t> peak_capacity = 0;
+
+    void Reset() noexcept {
+        for (auto* counter : {&allocations, &deallocations, &bytes_allocated,
+                              &reallocations, &relocated_elements, &peak_capacity})
+            counter->store(0, std::memory_order_relaxed);
+    }
+};
+
+namespace detail {
+
+struct Registry {
+    std::mutex mutex;
+    std::deque<std::pair<std::string, Counters>> entries;
+};
+
+inline Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+template <typename Container>
+std::string TypeName() {
+    const char* name = typeid(Container).name();
+#if __has_include(<cxxabi.h>)
+    int status = 0;
+    std::unique_ptr<char, void (*)(void*)> demangled(
+        abi::__cxa_demangle(name, nullptr, nullptr, &status),
+        std::free
+    );
+    if (status == 0)
+        return demangled.get();
+#endif
+    return name;
+}
+
+inline Counters& Register(std::string name) {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    return registry.entries.emplace_back(
+        std::piecewise_construct,
+        std::forward_as_tuple(std::move(name)),
+        std::forward_as_tuple()
+    ).second;
+}
+
+inline void Add(std::atomic<uint64_t>& counter, uint64_t value) noexcept {
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+inline void Max(std::atomic<uint64_t>& counter, uint64_t value) noexcept {
+    uint64_t current = counter.load(std::memory_order_relaxed);
+    while (current < value
+           && !counter.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+inline void WriteJson(std::ostream& out, const Counters& counters) {
+    out << "{\"allocations\": " << counters.allocations.load()
+        << ", \"deallocations\": " << counters.deallocations.load()
+        << ", \"bytes_allocated\": " << counters.bytes_allocated.load()
+        << ", \"reallocations\": " << counters.reallocations.load()
+        << ", \"relocated_elements\": " << counters.relocated_elements.load()
+        << ", \"peak_capacity\": " << counters.peak_capacity.load() << '}';
+}
+
+} // namespace detail
+
+// ---------- Counters ----------------
+
+inline Counters& Global() noexcept {
+    static Counters counters;
+    return counters;
+}
+
+// Counters of one container type, e.g. Vector<int>
+template <typename Container>
+Counters& For() {
+    static Counters& counters = detail::Register(detail::TypeName<Container>());
+    return counters;
+}
+
+inline void Reset() {
+    Global().Reset();
+
+    detail::Registry& registry = detail::GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    for (auto& [name, counters] : registry.entries)
+        counters.Reset();
+}
+
+// Writes {"global": {...}, "types": {"<type>": {...}, ...}}
+inline void DumpJson(std::ostream& out) {
+    out << "{\"global\": ";
+    detail::WriteJson(out, Global());
+    out << ", \"types\": {";
+
+    detail::Registry& registry = detail::GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    bool first = true;
+    for (const auto& [name, counters] : registry.entries) {
+        out << (first ? "\"" : ", \"");
+        for (char c : name) {
+            if (c == '"' || c == '\\')
+                out << '\\';
+            out << c;
+        }
+        out << "\": ";
+        detail::WriteJson(out, counters);
+        first = false;
+    }
+    out << "}}";
+}
+
+// ---------- Events ------------------
+
+// A container took a new buffer of `capacity` elements
+template <typename Container>
+void OnAllocate(size_t capacity, size_t element_size) {
+    if (!capacity)
+        return;
+
+    for (Counters* counters : {&Global(), &For<Container>()}) {
+        detail::Add(counters->allocations, 1);
+        detail::Add(counters->bytes_allocated, capacity*element_size);
+        detail::Max(counters->peak_capacity, capacity);
+    }
+}
+
+// A container released a buffer of `capacity` elements
+template <typename Container>
+void OnDeallocate(size_t capacity, [[maybe_unused]] size_t element_size) {
+    if (!capacity)
+        return;
+
+    for (Counters* counters : {&Global(), &For<Container>()})
+        detail::Add(counters->deallocations, 1);
+}
+
+// A container replaced its buffer with a larger (or smaller) one, moving
+// `relocated` elements over; a buffer resized in place relocates none
+template <typename Container>
+void OnReallocate(size_t old_capacity, size_t new_capacity,
+                  size_t relocated, size_t element_size) {
+    if (!old_capacity)
+        return OnAllocate<Container>(new_capacity, element_size);
+
+    for (Counters* counters : {&Global(), &For<Container>()}) {
+        detail::Add(counters->allocations, 1);
+        detail::Add(counters->deallocations, 1);
+        detail::Add(counters->bytes_allocated, new_capacity*element_size);
+        detail::Add(counters->reallocations, 1);
+        detail::Add(counters->relocated_elements, relocated);
+        detail::Max(counters->peak_capacity, new_capacity);
+    }
+}
+
+} // namespace cstl::instrumentation
+
+#else
+#define CSTL_INSTRUMENT(Event, ...) static_cast<void>(0)
+#endif
@@ -0,0 +1,293 @@
+#pragma once
+#if defined(__unix__)
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "vector/growth_policy.h"
+
+namespace cstl {
+
+// Vector of trivially copyable elements stored in a file mapped with mmap.
+// Opening an existing file only maps it, so a large vector is available
+// immediately without being read or parsed. The file holds a 64-byte header
+// (magic, version, element size, element count) followed by the elements;
+// growth extends it with ftruncate and maps it again, so elements move in
+// memory but are never copied. Pointers and iterators are invalidated by
+// growth as with Vector.
+//
+// Changes reach the file when the kernel writes dirty pages back; Sync()
+// forces that for the whole vector or a range of it.
+//
+// A moved-from vector owns no file. It reads as empty and may be cleared,
+// destroyed or assigned to; growing it throws std::logic_error.
+template <typename T, typename GrowthPolicy = DoublingGrowth<>>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "elements are persisted as raw bytes");
+
+    struct Header {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t element_size;
+        uint64_t size;
+        uint64_t reserved[5];
+    };
+
+    static constexpr uint64_t MAGIC = 0x5254'4356'4c54'5343; // "CSTLVCTR"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = sizeof(Header);
+
+    static_assert(HEADER_SIZE == 64);
+    static_assert(alignof(T) <= HEADER_SIZE, "elements must fit header alignment");
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+public:
+    // Opens the vector stored at `path`, creating an empty one if the file
+    // does not exist or is empty
+    explicit MappedVector(const std::filesystem::path& path) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0)
+            ThrowSystemError("open");
+
+        try {
+            struct stat st{};
+            if (::fstat(fd_, &st) != 0)
+                ThrowSystemError("fstat");
+
+            if (st.st_size == 0) {
+                Remap(PageSize());
+                *GetHeader() = Header{MAGIC, VERSION, sizeof(T), 0, {}};
+            } else {
+                if (static_cast<size_t>(st.st_size) < HEADER_SIZE)
+                    throw std::runtime_error("MappedVector: file too short for a header");
+                Remap(st.st_size);
+                Validate();
+            }
+        } catch (...) {
+            Unmap();
+            ::close(fd_);
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+            : fd_(std::exchange(other.fd_, -1))
+            , mapping_(std::exchange(other.mapping_, nullptr))
+            , mapping_size_(std::exchange(other.mapping_size_, 0))
+            , growth_(std::move(other.growth_)) {
+    }
+
+    ~MappedVector() {
+        Unmap();
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        Swap(rhs);
+        return *this;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<MappedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        return Data()[index];
+    }
+
+    iterator begin() noexcept {
+        return Data();
+    }
+
+    iterator end() noexcept {
+        return Data() + Size();
+    }
+
+    const_iterator begin() const noexcept {
+        return const_cast<MappedVector&>(*this).Data();
+    }
+
+    const_iterator end() const noexcept {
+        return begin() + Size();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    void Swap(MappedVector& other) noexcept {
+        std::swap(fd_, other.fd_);
+        std::swap(mapping_, other.mapping_);
+        std::swap(mapping_size_, other.mapping_size_);
+        std::swap(growth_, other.growth_);
+    }
+
+    size_t Size() const noexcept {
+        return mapping_ ? GetHeader()->size : 0;
+    }
+
+    size_t Capacity() const noexcept {
+        return mapping_ ? (mapping_size_ - HEADER_SIZE)/sizeof(T) : 0;
+    }
+
+    // Extends the file to hold `new_capacity` elements, rounded up to whole
+    // pages
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity())
+            return;
+        if (fd_ < 0)
+            throw std::logic_error("MappedVector: moved-from vector has no file");
+
+        const size_t page_size = PageSize();
+        const size_t bytes = HEADER_SIZE + new_capacity*sizeof(T);
+        Remap((bytes + page_size - 1)/page_size*page_size);
+    }
+
+    void Resize(size_t new_size) {
+        // Reserve maps nothing for a moved-from vector resized to 0
+        if (!new_size)
+            return Clear();
+        Reserve(new_size);
+
+        if (Size() < new_size)
+            std::uninitialized_value_construct_n(end(), new_size - Size());
+        GetHeader()->size = new_size;
+    }
+
+    void Clear() noexcept {
+        if (mapping_)
+            GetHeader()->size = 0;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        // Built first: args may refer into the mapping, which growth moves
+        const T value(std::forward<Args>(args)...);
+        if (Size() == Capacity())
+            Reserve(growth_.NextCapacity(Capacity(), Size() + 1, sizeof(T)));
+
+        T* slot = new (end()) T(value);
+        ++GetHeader()->size;
+        return *slot;
+    }
+
+    void PopBack() noexcept {
+        assert(Size());
+        --GetHeader()->size;
+    }
+
+    // Writes the header and all elements back to the file
+    void Sync() {
+        if (::msync(mapping_, mapping_size_, MS_SYNC) != 0)
+            ThrowSystemError("msync");
+    }
+
+    // Writes the header and elements [first, last) back to the file
+    void Sync(size_t first, size_t last) {
+        assert(first <= last && last <= Capacity());
+
+        const size_t page_size = PageSize();
+        const size_t from = (HEADER_SIZE + first*sizeof(T))/page_size*page_size;
+        const size_t to = HEADER_SIZE + last*sizeof(T);
+        if (from != 0 && ::msync(mapping_, HEADER_SIZE, MS_SYNC) != 0)
+            ThrowSystemError("msync");
+        if (to > from && ::msync(mapping_ + from, to - from, MS_SYNC) != 0)
+            ThrowSystemError("msync");
+    }
+
+private:
+    int fd_ = -1;
+    std::byte* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    [[no_unique_address]] GrowthPolicy growth_{};
+
+    Header* GetHeader() const noexcept {
+        return reinterpret_cast<Header*>(mapping_);
+    }
+
+    // Null for a moved-from vector, so begin() == end() without arithmetic
+    // on a null mapping
+    T* Data() noexcept {
+        return mapping_ ? reinterpret_cast<T*>(mapping_ + HEADER_SIZE) : nullptr;
+    }
+
+    void Validate() const {
+        const Header& header = *GetHeader();
+        if (header.magic != MAGIC)
+            throw std::runtime_error("MappedVector: not a vector file");
+        if (header.version != VERSION)
+            throw std::runtime_error("MappedVector: unsupported version");
+        if (header.element_size != sizeof(T))
+            throw std::runtime_error("MappedVector: element size mismatch");
+        if (header.size > Capacity())
+            throw std::runtime_error("MappedVector: file is truncated");
+    }
+
+    // Resizes the file to `bytes` and maps all of it
+    void Remap(size_t bytes) {
+        if (bytes != mapping_size_ && ::ftruncate(fd_, bytes) != 0)
+            ThrowSystemError("ftruncate");
+
+        void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, fd_, 0);
+        if (mapping == MAP_FAILED)
+            ThrowSystemError("mmap");
+
+        Unmap();
+        mapping_ = static_cast<std::byte*>(mapping);
+        mapping_size_ = bytes;
+    }
+
+    void Unmap() noexcept {
+        if (mapping_)
+            ::munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+        mapping_size_ = 0;
+    }
+
+    static size_t PageSize() noexcept {
+        return static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    }
+
+    [[noreturn]] static void ThrowSystemError(const char* what) {
+        throw std::system_error(errno, std::generic_category(),
+                                std::string("MappedVector: ") + what);
+    }
+};
+
+} // namespace cstl
+#endif
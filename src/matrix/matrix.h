@@ -1,11 +1,44 @@
 #pragma once
 #include <algorithm>
+#include <memory>
 #include <optional>
 #include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "instrumentation/instrumentation.h"
+#include "parallel/parallel.h"
+#include "vector/uninitialized.h"
+
 namespace cstl {
 
+namespace detail {
+
+// std::allocator whose argument-less construct() default-initialises, so a
+// std::vector of trivial elements can be sized without being written
+template <typename T>
+struct DefaultInitAllocator : std::allocator<T> {
+    template <typename U>
+    struct rebind {
+        using other = DefaultInitAllocator<U>;
+    };
+
+    using std::allocator<T>::allocator;
+
+    // Constant evaluation has no indeterminate values: elements are zeroed
+    // there
+    template <typename U, typename... Args>
+    constexpr void construct(U* p, Args&&... args) {
+        if (sizeof...(Args) != 0 || std::is_constant_evaluated())
+            std::construct_at(p, std::forward<Args>(args)...);
+        else
+            ::new (static_cast<void*>(p)) U;
+    }
+};
+
+} // namespace detail
+
 struct Shape {
     size_t rows = 0;
     size_t cols = 0;
@@ -13,52 +46,102 @@ struct Shape {
 
 template <typename Type>
 class Matrix {
+    // Trivial elements are allocated unwritten and then filled by
+    // parallel::FillN / CopyN, which split large buffers across threads
+    static constexpr bool FILLS_IN_PARALLEL = std::is_trivially_copyable_v<Type>
+        && std::is_trivially_default_constructible_v<Type>;
+
+    using Storage = std::conditional_t<
+        FILLS_IN_PARALLEL,
+        std::vector<Type, detail::DefaultInitAllocator<Type>>,
+        std::vector<Type>
+    >;
+
 public:
-    using Iterator = typename std::vector<Type>::iterator;
-    using ConstIterator = typename std::vector<Type>::const_iterator;
+    using Iterator = typename Storage::iterator;
+    using ConstIterator = typename Storage::const_iterator;
     using Row = std::span<Type>;
 
 public:
 // ---------- Special Members ---------
 
-    inline Matrix() noexcept = default;
+    constexpr Matrix() noexcept = default;
 
-    inline Matrix(const size_t rows, const size_t cols, const Type& value = {})
+    constexpr Matrix(const size_t rows, const size_t cols, const Type& value = {})
         : Matrix({rows, cols}, value) {}
 
-    inline Matrix(const Matrix& other)
-            : Matrix({other.shape_.rows, other.shape_.cols}, {}) {
-        std::copy(other.elements_.begin(), other.elements_.end(),
-                  elements_.begin());
-        if (tr_elements_)
-            std::copy(other.tr_elements_->begin(), other.tr_elements_->end(),
-                      tr_elements_->begin());
+    constexpr Matrix(const Matrix& other)
+            : shape_(other.shape_)
+            , elements_(CopyOf(other.elements_.data(), other.elements_.size())) {
+        CSTL_INSTRUMENT(OnAllocate, elements_.size(), sizeof(Type));
+        if (other.tr_elements_) {
+            tr_elements_ = CopyOf(other.tr_elements_->data(), other.tr_elements_->size());
+            CSTL_INSTRUMENT(OnAllocate, tr_elements_->size(), sizeof(Type));
+        }
+    }
+
+    constexpr explicit Matrix(const Shape shape, const Type& value = {})
+        : shape_(shape)
+        , elements_(Filled(shape.cols * shape.rows, value)) {
+        CSTL_INSTRUMENT(OnAllocate, elements_.size(), sizeof(Type));
     }
 
-    explicit Matrix(const Shape shape, const Type& value = {})
+    // Trivial elements are left unwritten
+    constexpr Matrix(const Shape shape, DefaultInit)
         : shape_(shape)
-        , elements_(shape.cols * shape.rows, value) {}
+        , elements_(shape.cols * shape.rows) {
+        CSTL_INSTRUMENT(OnAllocate, elements_.size(), sizeof(Type));
+    }
+
+    constexpr Matrix(const size_t rows, const size_t cols, const Type* data)
+        : shape_{rows, cols}
+        , elements_(CopyOf(data, rows * cols)) {
+        CSTL_INSTRUMENT(OnAllocate, elements_.size(), sizeof(Type));
+    }
 
-    inline Matrix(const size_t rows, const size_t cols, const Type* data)
-            : Matrix(rows, cols) {
-        std::copy(data, data + elements_.size(), elements_.begin());
+    constexpr Matrix(Matrix&& other) noexcept
+        : Matrix() {
+        Swap(other);
+    }
+
+    constexpr Matrix& operator=(const Matrix& rhs) {
+        if (this != &rhs) {
+            Matrix copy(rhs);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    // The old buffers are released, and reported, by `old`
+    constexpr Matrix& operator=(Matrix&& rhs) noexcept {
+        if (this != &rhs) {
+            Matrix old(std::move(rhs));
+            Swap(old);
+        }
+        return *this;
+    }
+
+    constexpr ~Matrix() {
+        CSTL_INSTRUMENT(OnDeallocate, elements_.size(), sizeof(Type));
+        if (tr_elements_)
+            CSTL_INSTRUMENT(OnDeallocate, tr_elements_->size(), sizeof(Type));
     }
 
 // ---------- Getters -----------------
 
-    inline const Shape& GetShape() const noexcept {
+    constexpr const Shape& GetShape() const noexcept {
         return shape_;
     }
 
-    inline Type* GetData() noexcept {
+    constexpr Type* GetData() noexcept {
         return elements_.data();
     }
 
-    inline const Type* GetData() const noexcept {
+    constexpr const Type* GetData() const noexcept {
         return elements_.data();
     }
 
-    inline Row operator[](const size_t i) {
+    constexpr Row operator[](const size_t i) {
         return {
             &(*std::next(elements_.begin(), i * shape_.cols)),
             shape_.cols
@@ -67,37 +150,38 @@ public:
 
 // ---------- Methods -----------------
 
-    inline void Swap(Matrix& other) noexcept {
+    constexpr void Swap(Matrix& other) noexcept {
         std::swap(shape_, other.shape_);
         elements_.swap(other.elements_);
         tr_elements_.swap(other.tr_elements_);
     }
 
-    inline Matrix T() const {
+    constexpr Matrix T() const {
         Matrix tr(*this);
         return tr.T();
     }
 
-    [[maybe_unused]] inline Matrix& T() {
+    [[maybe_unused]] constexpr Matrix& T() {
         return Transpose(elements_.begin(), elements_.end());
     }
 
     // Update transpose
-    [[maybe_unused]] inline Matrix& Transpose() {
+    [[maybe_unused]] constexpr Matrix& Transpose() {
         Transpose(elements_.begin(), elements_.end(), tr_elements_->begin());
         return Transpose(elements_.begin(), elements_.end());
     }
 
     // Fill transpose
     template<typename InputIt>
-    [[maybe_unused]] Matrix& Transpose(InputIt first, InputIt last) {
+    [[maybe_unused]] constexpr Matrix& Transpose(InputIt first, InputIt last) {
         if (tr_elements_) {
             std::swap(shape_.rows, shape_.cols);
             elements_.swap(*tr_elements_);
             return *this;
         }
 
-        tr_elements_ = std::vector<Type>(elements_.size());
+        tr_elements_ = Storage(elements_.size());
+        CSTL_INSTRUMENT(OnAllocate, tr_elements_->size(), sizeof(Type));
         Transpose(first, last, tr_elements_->begin());
 
         std::swap(shape_.rows, shape_.cols);
@@ -107,11 +191,31 @@ public:
 
 private:
     Shape shape_{};
-    std::vector<Type> elements_{};
-    std::optional<std::vector<Type>> tr_elements_ = std::nullopt;
+    Storage elements_{};
+    std::optional<Storage> tr_elements_ = std::nullopt;
+
+    static constexpr Storage Filled(size_t count, const Type& value) {
+        if constexpr (FILLS_IN_PARALLEL) {
+            Storage elements(count);
+            parallel::FillN(elements.data(), count, value);
+            return elements;
+        } else {
+            return Storage(count, value);
+        }
+    }
+
+    static constexpr Storage CopyOf(const Type* data, size_t count) {
+        if constexpr (FILLS_IN_PARALLEL) {
+            Storage elements(count);
+            parallel::CopyN(data, count, elements.data());
+            return elements;
+        } else {
+            return Storage(data, data + count);
+        }
+    }
 
     template<typename InputIt, typename OutputIt>
-    void Transpose(InputIt first, InputIt last, OutputIt d_first) {
+    constexpr void Transpose(InputIt first, InputIt last, OutputIt d_first) {
         const auto& index = [&](size_t x, size_t y) {
             return x + y * shape_.cols;
         };
@@ -1,4 +1,6 @@
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 
 namespace cstl {
@@ -15,141 +17,159 @@ public:
 template <typename T>
 class Optional {
 public:
-    Optional() = default;
+    constexpr Optional() noexcept {}
 
-    Optional(const T& value) {
-        new (data_) T(value);
+    constexpr Optional(const T& value) {
+        std::construct_at(&value_, value);
         is_initialized_ = true;
     }
 
-    Optional(T&& value) {
-        new (data_) T(std::move(value));
+    constexpr Optional(T&& value) {
+        std::construct_at(&value_, std::move(value));
         is_initialized_ = true;
     }
 
-    Optional(const Optional& other) {
+    constexpr Optional(const Optional& other) {
         if (other.is_initialized_) {
-            new (data_) T(other.Value());
+            std::construct_at(&value_, other.Value());
             is_initialized_ = true;
         }
     }
 
-    Optional(Optional&& other) {
+    constexpr Optional(Optional&& other) {
         if (other.is_initialized_) {
-            new (data_) T(std::move(other.Value()));
+            std::construct_at(&value_, std::move(other.Value()));
             is_initialized_ = true;
         }
     }
 
-    ~Optional() {
+    constexpr ~Optional() {
         Reset();
     }
 
-    Optional& operator=(const T& rhs) {
+    constexpr Optional& operator=(const T& rhs) {
         if (is_initialized_) {
             **this = rhs;
         } else {
-            new (data_) T(rhs);
+            std::construct_at(&value_, rhs);
             is_initialized_ = true;
         }
         return *this;
     }
 
-    Optional& operator=(T&& rhs) {
+    constexpr Optional& operator=(T&& rhs) {
         if (is_initialized_) {
             **this = std::move(rhs);
         } else {
-            new (data_) T(std::move(rhs));
+            std::construct_at(&value_, std::move(rhs));
             is_initialized_ = true;
         }
         return *this;
     }
 
-    Optional& operator=(const Optional& rhs) {
+    constexpr Optional& operator=(const Optional& rhs) {
         if (!rhs.is_initialized_) {
             Reset();
         } else if (is_initialized_ && rhs.is_initialized_) {
             **this = rhs.Value();
         } else {
-            new (data_) T(rhs.Value());
+            std::construct_at(&value_, rhs.Value());
             is_initialized_ = true;
         }
         return *this;
     }
 
-    Optional& operator=(Optional&& rhs) {
+    constexpr Optional& operator=(Optional&& rhs) {
         if (!rhs.is_initialized_) {
             Reset();
         } else if (is_initialized_ && rhs.is_initialized_) {
             **this = std::move(rhs.Value());
         } else {
-            new (data_) T(std::move(rhs.Value()));
+            std::construct_at(&value_, std::move(rhs.Value()));
             is_initialized_ = true;
         }
         return *this;
     }
 
-    inline bool HasValue() const {
+    constexpr bool HasValue() const {
         return is_initialized_;
     }
 
-    inline T& operator*() & {
-        return *reinterpret_cast<T*>(data_);
+    constexpr T& operator*() & {
+        return value_;
     }
 
-    inline T&& operator*() && {
-        return std::move(*reinterpret_cast<T*>(data_));
+    constexpr T&& operator*() && {
+        return std::move(value_);
     }
 
-    inline const T& operator*() const& {
-        return *reinterpret_cast<const T*>(data_);
+    constexpr const T& operator*() const& {
+        return value_;
     }
 
-    inline T* operator->() {
-        return reinterpret_cast<T*>(data_);
+    constexpr T* operator->() {
+        return &value_;
     }
 
-    inline const T* operator->() const {
-        return reinterpret_cast<const T*>(data_);
+    constexpr const T* operator->() const {
+        return &value_;
     }
 
-    T& Value() & {
+    constexpr T& Value() & {
         if (is_initialized_)
-            return *reinterpret_cast<T*>(data_);
+            return value_;
         else
             throw BadOptionalAccess();
     }
 
-    T&& Value() && {
+    constexpr T&& Value() && {
         if (is_initialized_)
-            return std::move(*reinterpret_cast<T*>(data_));
+            return std::move(value_);
         else
             throw BadOptionalAccess();
     }
 
-    const T& Value() const& {
+    constexpr const T& Value() const& {
         if (is_initialized_)
-            return *reinterpret_cast<const T*>(data_);
+            return value_;
         else
             throw BadOptionalAccess();
     }
 
 
-    void Reset() {
+    constexpr void Reset() {
         if (is_initialized_) {
-            reinterpret_cast<T*>(data_)->~T();
+            std::destroy_at(&value_);
             is_initialized_ = false;
         }
     }
 
+    // Replaces the value. The arguments may refer to the old value: the new
+    // one is built aside and moved in, unless T cannot be moved, in which
+    // case the old value is destroyed first
     template<typename ...Args>
-    void Emplace(Args&&... args) {
-        new (data_) T(std::forward<Args>(args)...);
+    constexpr void Emplace(Args&&... args) {
+        if constexpr (std::is_move_constructible_v<T>) {
+            if (is_initialized_) {
+                T tmp(std::forward<Args>(args)...);
+                Reset();
+                std::construct_at(&value_, std::move(tmp));
+                is_initialized_ = true;
+                return;
+            }
+        }
+        Reset();
+        std::construct_at(&value_, std::forward<Args>(args)...);
         is_initialized_ = true;
     }
 
 private:
-    alignas(T) char data_[sizeof(T)];
+    // A union member is neither constructed nor destroyed implicitly; empty_
+    // keeps an empty Optional fully initialised for constant expressions
+    union {
+        char empty_ = 0;
+        T value_;
+    };
     bool is_initialized_ = false;
 };
 
@@ -0,0 +1,237 @@
+#pragma once
+
+// Multi-threaded initialisation of large buffers. Below a size threshold, or
+// for element types whose construction may throw, every function here is the
+// plain sequential algorithm. Above it the range is cut into page-aligned
+// chunks, one per task, so each page is first touched (and therefore placed
+// by the kernel) on the thread that fills it.
+//
+// Tasks run on an executor: a callable run(count, task) that invokes
+// task(0) ... task(count - 1), possibly concurrently, and returns once all
+// of them finished. The default one starts a thread per task and runs the
+// first task on the calling thread. Install another with SetOptions, e.g.
+// to reuse a thread pool.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "vector/uninitialized.h"
+
+namespace cstl::parallel {
+
+using Task = std::function<void(size_t)>;
+using Executor = std::function<void(size_t count, const Task& task)>;
+
+// Chunks are aligned to this many bytes; with larger pages a few boundary
+// pages are shared between neighbouring tasks
+inline constexpr size_t PAGE_BYTES = 4096;
+
+inline constexpr size_t DEFAULT_MIN_BYTES = size_t{32} << 20;
+
+struct Options {
+    // Buffers smaller than this are initialised on the calling thread
+    size_t min_bytes = DEFAULT_MIN_BYTES;
+    // Upper bound on the number of tasks; 0 means hardware_concurrency()
+    size_t max_tasks = 0;
+    // Empty means DefaultExecutor
+    Executor executor;
+};
+
+// Runs task 0 on the calling thread and the others on their own threads. If
+// a thread cannot be started its task runs on the calling thread instead.
+inline void DefaultExecutor(size_t count, const Task& task) {
+    std::vector<std::jthread> threads;
+    threads.reserve(count ? count - 1 : 0);
+
+    for (size_t i = 1; i < count; ++i) {
+        try {
+            threads.emplace_back(task, i);
+        } catch (const std::system_error&) {
+            task(i);
+        }
+    }
+    if (count)
+        task(0);
+}
+
+namespace detail {
+
+struct State {
+    std::atomic<size_t> min_bytes = DEFAULT_MIN_BYTES;
+    std::mutex mutex;
+    Options options;
+};
+
+inline State& GetState() {
+    static State state;
+    return state;
+}
+
+// Splits [first, first + count) into at most `tasks` chunks whose
+// boundaries fall on page boundaries, and returns the boundaries
+template <typename T>
+std::vector<size_t> SplitPages(const T* first, size_t count, size_t tasks) {
+    const auto begin = reinterpret_cast<uintptr_t>(first);
+    const size_t step = (count*sizeof(T) + tasks - 1)/tasks;
+
+    std::vector<size_t> bounds{0};
+    for (size_t i = 1; i < tasks; ++i) {
+        uintptr_t address = begin + i*step;
+        address += (PAGE_BYTES - address % PAGE_BYTES) % PAGE_BYTES;
+        const size_t index = std::min<size_t>(
+            count,
+            (address - begin + sizeof(T) - 1)/sizeof(T)
+        );
+        if (index > bounds.back())
+            bounds.push_back(index);
+    }
+    if (count > bounds.back())
+        bounds.push_back(count);
+    return bounds;
+}
+
+// Runs chunk(from, to) over [0, count) of `first`, in parallel when the
+// buffer is large enough; returns false (doing nothing) otherwise
+template <typename T, typename Chunk>
+bool ForEachChunk(const T* first, size_t count, Chunk chunk) {
+    State& state = GetState();
+    if (count*sizeof(T) < state.min_bytes.load(std::memory_order_relaxed))
+        return false;
+
+    Options options;
+    {
+        std::lock_guard lock(state.mutex);
+        options = state.options;
+    }
+
+    size_t tasks = options.max_tasks ? options.max_tasks
+                                     : std::thread::hardware_concurrency();
+    tasks = std::min(tasks, count*sizeof(T)/PAGE_BYTES);
+    if (tasks < 2)
+        return false;
+
+    const std::vector<size_t> bounds = SplitPages(first, count, tasks);
+    const Task task = [&](size_t i) { chunk(bounds[i], bounds[i + 1]); };
+    if (options.executor)
+        options.executor(bounds.size() - 1, task);
+    else
+        DefaultExecutor(bounds.size() - 1, task);
+    return true;
+}
+
+} // namespace detail
+
+// ---------- Options -----------------
+
+inline Options GetOptions() {
+    detail::State& state = detail::GetState();
+    std::lock_guard lock(state.mutex);
+    return state.options;
+}
+
+// Returns the previous options
+inline Options SetOptions(Options options) {
+    detail::State& state = detail::GetState();
+    std::lock_guard lock(state.mutex);
+    state.min_bytes.store(options.min_bytes, std::memory_order_relaxed);
+    return std::exchange(state.options, std::move(options));
+}
+
+// ---------- Algorithms --------------
+
+// The executor must run every task: with nothrow element operations there is
+// nothing to roll back, so the functions below are restricted to those. In
+// constant evaluation they are always sequential.
+
+template <typename T>
+constexpr void UninitializedValueConstructN(T* first, size_t count) {
+    if constexpr (std::is_nothrow_default_constructible_v<T>) {
+        const auto chunk = [first](size_t from, size_t to) {
+            std::uninitialized_value_construct_n(first + from, to - from);
+        };
+        if (!std::is_constant_evaluated() && detail::ForEachChunk(first, count, chunk))
+            return;
+    }
+    cstl::detail::UninitializedValueConstructN(first, count);
+}
+
+template <typename T>
+constexpr void UninitializedCopyN(const T* source, size_t count, T* d_first) {
+    if constexpr (std::is_nothrow_copy_constructible_v<T>) {
+        const auto chunk = [=](size_t from, size_t to) {
+            std::uninitialized_copy_n(source + from, to - from, d_first + from);
+        };
+        if (!std::is_constant_evaluated() && detail::ForEachChunk(d_first, count, chunk))
+            return;
+    }
+    cstl::detail::UninitializedCopyN(source, count, d_first);
+}
+
+template <typename T>
+constexpr void UninitializedFillN(T* first, size_t count, const T& value) {
+    if constexpr (std::is_nothrow_copy_constructible_v<T>) {
+        const auto chunk = [first, &value](size_t from, size_t to) {
+            std::uninitialized_fill_n(first + from, to - from, value);
+        };
+        if (!std::is_constant_evaluated() && detail::ForEachChunk(first, count, chunk))
+            return;
+    }
+    cstl::detail::UninitializedFillN(first, count, value);
+}
+
+// Allocators with their own construct() build the elements sequentially
+// through it
+
+template <typename Allocator, typename T>
+constexpr void UninitializedValueConstructN(Allocator& alloc, T* first, size_t count) {
+    if constexpr (cstl::detail::constructs_in_place_v<Allocator, T>)
+        UninitializedValueConstructN(first, count);
+    else
+        cstl::detail::UninitializedValueConstructN(alloc, first, count);
+}
+
+template <typename Allocator, typename T>
+constexpr void UninitializedCopyN(Allocator& alloc, const T* source, size_t count, T* d_first) {
+    if constexpr (cstl::detail::constructs_in_place_v<Allocator, T>)
+        UninitializedCopyN(source, count, d_first);
+    else
+        cstl::detail::UninitializedCopyN(alloc, source, count, d_first);
+}
+
+// Assigning over live elements; for buffers of trivial types that were
+// allocated but not yet written
+template <typename T>
+constexpr void CopyN(const T* source, size_t count, T* d_first) {
+    if constexpr (std::is_nothrow_copy_assignable_v<T>) {
+        const auto chunk = [=](size_t from, size_t to) {
+            std::copy_n(source + from, to - from, d_first + from);
+        };
+        if (!std::is_constant_evaluated() && detail::ForEachChunk(d_first, count, chunk))
+            return;
+    }
+    std::copy_n(source, count, d_first);
+}
+
+template <typename T>
+constexpr void FillN(T* first, size_t count, const T& value) {
+    if constexpr (std::is_nothrow_copy_assignable_v<T>) {
+        const auto chunk = [first, &value](size_t from, size_t to) {
+            std::fill_n(first + from, to - from, value);
+        };
+        if (!std::is_constant_evaluated() && detail::ForEachChunk(first, count, chunk))
+            return;
+    }
+    std::fill_n(first, count, value);
+}
+
+} // namespace cstl::parallel
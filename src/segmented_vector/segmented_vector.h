@@ -0,0 +1,254 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "vector/index_iterator.h"
+#include "vector/uninitialized.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+// Block size holding about a page worth of elements
+template <typename T>
+inline constexpr size_t DEFAULT_BLOCK_SIZE
+    = std::bit_floor(std::max<size_t>(1, 4096/sizeof(T)));
+
+// Deque-like vector: elements live in fixed-size RawMemory blocks listed in
+// a table, so PushBack never relocates elements and references and iterators
+// stay valid until the element is removed. Indexing costs a shift and a mask.
+template <typename T,
+          size_t BlockSize = DEFAULT_BLOCK_SIZE<T>,
+          typename Allocator = std::allocator<T>>
+class SegmentedVector {
+    static_assert(std::has_single_bit(BlockSize),
+                  "block size must be a power of two");
+
+    static constexpr size_t BLOCK_BITS = std::countr_zero(BlockSize);
+    static constexpr size_t BLOCK_MASK = BlockSize - 1;
+
+    using Block = RawMemory<T, Allocator>;
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    template <bool IsConst>
+    struct IteratorAccess {
+        using Container = SegmentedVector;
+        using Handle = std::conditional_t<IsConst, const SegmentedVector*, SegmentedVector*>;
+        using value_type = T;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        // Through the container, not the block table, which moves when a
+        // block is added
+        static reference Get(Handle vector, size_t index) noexcept {
+            return vector->blocks_[index >> BLOCK_BITS][index & BLOCK_MASK];
+        }
+    };
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = detail::IndexIterator<IteratorAccess, false>;
+    using const_iterator = detail::IndexIterator<IteratorAccess, true>;
+
+public:
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const Allocator& alloc)
+            : alloc_(alloc) {
+    }
+
+    // Delegating first makes ~SegmentedVector destroy the elements already
+    // built if a later one throws
+    explicit SegmentedVector(const size_t size, const Allocator& alloc = Allocator())
+            : SegmentedVector(alloc) {
+        Resize(size);
+    }
+
+    SegmentedVector(const SegmentedVector& other)
+            : SegmentedVector(
+                other,
+                AllocTraits::select_on_container_copy_construction(other.alloc_)
+            ) {
+    }
+
+    SegmentedVector(const SegmentedVector& other, const Allocator& alloc)
+            : SegmentedVector(alloc) {
+        Reserve(other.size_);
+        for (const T& value : other)
+            EmplaceBack(value);
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+            : blocks_(std::move(other.blocks_))
+            , size_(std::exchange(other.size_, 0))
+            , alloc_(other.alloc_) {
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    // Blocks hold a copy of the allocator they came from, so they may change
+    // hands between vectors whose allocators differ
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this == &rhs)
+            return *this;
+
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            // rhs_copy destroys the old elements with the old allocator
+            SegmentedVector rhs_copy(rhs, rhs.alloc_);
+            SwapBlocks(rhs_copy);
+            using std::swap;
+            swap(alloc_, rhs_copy.alloc_);
+        } else {
+            SegmentedVector rhs_copy(rhs, alloc_);
+            SwapBlocks(rhs_copy);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value
+        || AllocTraits::is_always_equal::value
+    ) {
+        if (this == &rhs)
+            return *this;
+
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            Clear();
+            blocks_ = std::move(rhs.blocks_);
+            size_ = std::exchange(rhs.size_, 0);
+            alloc_ = rhs.alloc_;
+        } else if (alloc_ == rhs.alloc_) {
+            SwapBlocks(rhs);
+        } else {
+            SegmentedVector tmp(alloc_);
+            tmp.Reserve(rhs.size_);
+            for (T& value : rhs)
+                tmp.EmplaceBack(std::move(value));
+            SwapBlocks(tmp);
+        }
+        return *this;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return blocks_[index >> BLOCK_BITS][index & BLOCK_MASK];
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+    void Swap(SegmentedVector& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
+        SwapBlocks(other);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return blocks_.Size()*BlockSize;
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Allocates blocks up front; existing elements stay where they are
+    void Reserve(size_t new_capacity) {
+        while (Capacity() < new_capacity)
+            blocks_.EmplaceBack(BlockSize, alloc_);
+    }
+
+    void Resize(size_t new_size) {
+        Reserve(new_size);
+
+        while (size_ < new_size)
+            EmplaceBack();
+        while (size_ > new_size)
+            PopBack();
+    }
+
+    // Destroys the elements, keeping the blocks
+    void Clear() noexcept {
+        while (size_)
+            PopBack();
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        // A new block never moves elements, so args may refer into *this
+        if (size_ == Capacity())
+            blocks_.EmplaceBack(BlockSize, alloc_);
+
+        T* slot = blocks_[size_ >> BLOCK_BITS] + (size_ & BLOCK_MASK);
+        detail::ConstructAt(alloc_, slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PopBack() noexcept {
+        assert(size_);
+
+        --size_;
+        detail::DestroyAt(alloc_, blocks_[size_ >> BLOCK_BITS] + (size_ & BLOCK_MASK));
+    }
+
+private:
+    Vector<Block> blocks_;
+    size_t size_ = 0;
+    [[no_unique_address]] Allocator alloc_{};
+
+    void SwapBlocks(SegmentedVector& other) noexcept {
+        blocks_.Swap(other.blocks_);
+        std::swap(size_, other.size_);
+    }
+};
+
+} // namespace cstl
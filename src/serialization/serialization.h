@@ -0,0 +1,304 @@
+#pragma once
+#if defined(__unix__)
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "matrix/matrix.h"
+#include "simple_vector/simple_vector.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+// Binary format for containers of trivially copyable elements: a 64-byte
+// header followed by the elements as raw bytes. Everything is little-endian,
+// which is the host byte order on the supported targets, so elements are
+// written and read without conversion. The header keeps the payload aligned
+// for any element type when the buffer itself is 64-byte aligned, e.g. a
+// mapped file.
+
+// What the payload holds: a 1-D array (Vector, SimpleVector) or a Matrix
+enum class BinaryContainer : uint8_t {
+    Array = 1,
+    Matrix = 2,
+};
+
+enum class ElementKind : uint8_t {
+    Opaque = 0,
+    Signed = 1,
+    Unsigned = 2,
+    Float = 3,
+};
+
+struct BinaryHeader {
+    uint32_t magic;
+    uint16_t version;
+    BinaryContainer container;
+    ElementKind element_kind;
+    uint64_t element_size;
+    uint64_t count;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t reserved[3];
+
+    static constexpr uint32_t MAGIC = 0x4c54'5343; // "CSTL"
+    static constexpr uint16_t VERSION = 1;
+
+    Shape GetShape() const noexcept {
+        return {static_cast<size_t>(rows), static_cast<size_t>(cols)};
+    }
+};
+
+static_assert(sizeof(BinaryHeader) == 64);
+
+// Elements of a serialized container viewed in place
+template <typename T>
+struct BinaryView {
+    BinaryContainer container;
+    Shape shape;
+    std::span<const T> elements;
+};
+
+namespace detail {
+
+template <typename T>
+constexpr ElementKind ElementKindOf() noexcept {
+    if constexpr (std::is_floating_point_v<T>)
+        return ElementKind::Float;
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        return ElementKind::Signed;
+    else if constexpr (std::is_integral_v<T>)
+        return ElementKind::Unsigned;
+    else
+        return ElementKind::Opaque;
+}
+
+template <typename T>
+constexpr void CheckSerializable() noexcept {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "elements are serialized as raw bytes");
+    static_assert(std::endian::native == std::endian::little,
+                  "the format is little-endian");
+}
+
+template <typename T>
+BinaryHeader MakeHeader(BinaryContainer container, size_t count, Shape shape) noexcept {
+    return {
+        BinaryHeader::MAGIC, BinaryHeader::VERSION, container,
+        ElementKindOf<T>(), sizeof(T), count, shape.rows, shape.cols, {}
+    };
+}
+
+// Most elements a container may hold, as for std::allocator<T>::max_size();
+// also keeps count*sizeof(T) from wrapping
+template <typename T>
+constexpr uint64_t MaxCount() noexcept {
+    return static_cast<uint64_t>(std::numeric_limits<std::ptrdiff_t>::max())/sizeof(T);
+}
+
+template <typename T>
+void CheckHeader(const BinaryHeader& header, BinaryContainer container) {
+    if (header.magic != BinaryHeader::MAGIC)
+        throw std::runtime_error("binary: not a cstl container");
+    if (header.version != BinaryHeader::VERSION)
+        throw std::runtime_error("binary: unsupported version");
+    if (header.container != container)
+        throw std::runtime_error("binary: container type mismatch");
+    if (header.element_kind != ElementKindOf<T>() || header.element_size != sizeof(T))
+        throw std::runtime_error("binary: element type mismatch");
+    if (header.count > MaxCount<T>())
+        throw std::runtime_error("binary: element count too large");
+    if (container == BinaryContainer::Matrix) {
+        uint64_t count;
+        if (__builtin_mul_overflow(header.rows, header.cols, &count)
+            || count != header.count)
+            throw std::runtime_error("binary: shape does not match the element count");
+    }
+}
+
+[[noreturn]] inline void ThrowSystemError(const char* what) {
+    throw std::system_error(errno, std::generic_category(),
+                            std::string("binary: ") + what);
+}
+
+// Writes the header and payload with writev, resuming after short writes
+inline void WriteAll(int fd, const BinaryHeader& header,
+                     const void* data, size_t bytes) {
+    iovec parts[2] = {
+        {const_cast<BinaryHeader*>(&header), sizeof(header)},
+        {const_cast<void*>(data), bytes},
+    };
+
+    iovec* part = parts;
+    int count = bytes ? 2 : 1;
+    while (count) {
+        const ssize_t written = ::writev(fd, part, count);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            ThrowSystemError("writev");
+        }
+
+        for (size_t left = written; left;) {
+            const size_t step = std::min(left, part->iov_len);
+            part->iov_base = static_cast<std::byte*>(part->iov_base) + step;
+            part->iov_len -= step;
+            left -= step;
+            if (!part->iov_len) {
+                ++part;
+                --count;
+            }
+        }
+    }
+}
+
+inline void ReadAll(int fd, void* data, size_t bytes) {
+    auto* out = static_cast<std::byte*>(data);
+    while (bytes) {
+        const ssize_t got = ::read(fd, out, bytes);
+        if (got < 0) {
+            if (errno == EINTR)
+                continue;
+            ThrowSystemError("read");
+        }
+        if (got == 0)
+            throw std::runtime_error("binary: unexpected end of file");
+
+        out += got;
+        bytes -= got;
+    }
+}
+
+// Rejects a payload longer than what is left of a regular file before
+// anything is allocated for it. Pipes and sockets are not checked: a short
+// one still fails in ReadAll.
+inline void CheckPayloadFits(int fd, uint64_t bytes) {
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+        ThrowSystemError("fstat");
+    if (!S_ISREG(st.st_mode))
+        return;
+
+    const off_t offset = ::lseek(fd, 0, SEEK_CUR);
+    if (offset < 0)
+        ThrowSystemError("lseek");
+    if (offset > st.st_size || bytes > static_cast<uint64_t>(st.st_size - offset))
+        throw std::runtime_error("binary: file too short for the elements");
+}
+
+template <typename T>
+BinaryHeader ReadHeader(int fd, BinaryContainer container) {
+    BinaryHeader header;
+    ReadAll(fd, &header, sizeof(header));
+    CheckHeader<T>(header, container);
+    CheckPayloadFits(fd, header.count*sizeof(T));
+    return header;
+}
+
+} // namespace detail
+
+// ---------- Writers -----------------
+
+template <typename T, typename Allocator, typename GrowthPolicy>
+void WriteBinary(int fd, const Vector<T, Allocator, GrowthPolicy>& v) {
+    detail::CheckSerializable<T>();
+    const auto header = detail::MakeHeader<T>(BinaryContainer::Array, v.Size(), {});
+    detail::WriteAll(fd, header, v.begin(), v.Size()*sizeof(T));
+}
+
+template <typename T>
+void WriteBinary(int fd, const SimpleVector<T>& v) {
+    detail::CheckSerializable<T>();
+    const auto header = detail::MakeHeader<T>(BinaryContainer::Array, v.GetSize(), {});
+    detail::WriteAll(fd, header, v.begin(), v.GetSize()*sizeof(T));
+}
+
+template <typename T>
+void WriteBinary(int fd, const Matrix<T>& m) {
+    detail::CheckSerializable<T>();
+    const Shape shape = m.GetShape();
+    const size_t count = shape.rows*shape.cols;
+    const auto header = detail::MakeHeader<T>(BinaryContainer::Matrix, count, shape);
+    detail::WriteAll(fd, header, m.GetData(), count*sizeof(T));
+}
+
+// ---------- Readers -----------------
+
+// Reads the elements straight into the vector's uninitialised tail
+template <typename T, typename Allocator = std::allocator<T>,
+          typename GrowthPolicy = DoublingGrowth<>>
+Vector<T, Allocator, GrowthPolicy> ReadVector(int fd, const Allocator& alloc = Allocator()) {
+    detail::CheckSerializable<T>();
+    const auto header = detail::ReadHeader<T>(fd, BinaryContainer::Array);
+
+    Vector<T, Allocator, GrowthPolicy> v(alloc);
+    v.ResizeAndOverwrite(header.count, [fd](T* data, size_t count) {
+        detail::ReadAll(fd, data, count*sizeof(T));
+        return count;
+    });
+    return v;
+}
+
+template <typename T>
+SimpleVector<T> ReadSimpleVector(int fd) {
+    detail::CheckSerializable<T>();
+    const auto header = detail::ReadHeader<T>(fd, BinaryContainer::Array);
+
+    SimpleVector<T> v(header.count, default_init);
+    detail::ReadAll(fd, v.begin(), header.count*sizeof(T));
+    return v;
+}
+
+template <typename T>
+Matrix<T> ReadMatrix(int fd) {
+    detail::CheckSerializable<T>();
+    const auto header = detail::ReadHeader<T>(fd, BinaryContainer::Matrix);
+
+    Matrix<T> m(header.GetShape(), default_init);
+    detail::ReadAll(fd, m.GetData(), header.count*sizeof(T));
+    return m;
+}
+
+// Views a serialized container inside `buffer` (e.g. a mapped file) without
+// copying; the view lives as long as the buffer
+template <typename T>
+BinaryView<T> ViewBinary(std::span<const std::byte> buffer) {
+    detail::CheckSerializable<T>();
+    if (buffer.size() < sizeof(BinaryHeader))
+        throw std::runtime_error("binary: buffer too short for a header");
+
+    BinaryHeader header;
+    std::memcpy(&header, buffer.data(), sizeof(header));
+    if (header.container != BinaryContainer::Matrix)
+        detail::CheckHeader<T>(header, BinaryContainer::Array);
+    else
+        detail::CheckHeader<T>(header, BinaryContainer::Matrix);
+
+    const std::byte* payload = buffer.data() + sizeof(header);
+    if (header.count > (buffer.size() - sizeof(header))/sizeof(T))
+        throw std::runtime_error("binary: buffer too short for the elements");
+    if (reinterpret_cast<uintptr_t>(payload) % alignof(T))
+        throw std::runtime_error("binary: misaligned buffer");
+
+    return {
+        header.container,
+        header.GetShape(),
+        {reinterpret_cast<const T*>(payload), static_cast<size_t>(header.count)}
+    };
+}
+
+} // namespace cstl
+#endif
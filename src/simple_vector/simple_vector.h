@@ -8,6 +8,9 @@
 
 #include "array_ptr.h"
 #include "size_obj_wrapper.h"
+#include "instrumentation/capacity_profiler.h"
+#include "instrumentation/instrumentation.h"
+#include "vector/uninitialized.h"
 
 namespace cstl {
 
@@ -19,49 +22,72 @@ class SimpleVector {
 public:
     /* --------------------- Special Member Functions ---------------------- */
 
-    SimpleVector() noexcept = default;
+    SimpleVector(CSTL_SITE_PARAM) noexcept : probe_(CSTL_SITE) {}
 
-    SimpleVector(size_t size) : SimpleVector(size, {}) {}
+    SimpleVector(size_t size CSTL_AND_SITE_PARAM) : SimpleVector(size, Type{} CSTL_AND_SITE) {}
 
-    explicit SimpleVector(size_t size, const Type& value)
+    explicit SimpleVector(size_t size, const Type& value CSTL_AND_SITE_PARAM)
         : capacity_(size)
         , size_(size)
         , elements_(size)
+        , probe_(CSTL_SITE)
     {
         std::fill(begin(), end(), value);
+        CSTL_INSTRUMENT(OnAllocate, capacity_, sizeof(Type));
     }
 
-    SimpleVector(size_t size, Type&& value)
+    // Trivial elements are left unwritten
+    explicit SimpleVector(size_t size, DefaultInit CSTL_AND_SITE_PARAM)
         : capacity_(size)
         , size_(size)
         , elements_(size)
+        , probe_(CSTL_SITE)
+    {
+        CSTL_INSTRUMENT(OnAllocate, capacity_, sizeof(Type));
+    }
+
+    SimpleVector(size_t size, Type&& value CSTL_AND_SITE_PARAM)
+        : capacity_(size)
+        , size_(size)
+        , elements_(size)
+        , probe_(CSTL_SITE)
     {
         for (size_t i = 0u; i < size_; ++i)
             At(i) = std::move(value);
+        CSTL_INSTRUMENT(OnAllocate, capacity_, sizeof(Type));
     }
 
-    SimpleVector(std::initializer_list<Type> init_values)
+    SimpleVector(std::initializer_list<Type> init_values CSTL_AND_SITE_PARAM)
         : capacity_(init_values.size())
         , size_(init_values.size())
         , elements_(init_values.size())
+        , probe_(CSTL_SITE)
     {
         std::move(init_values.begin(), init_values.end(), begin());
+        CSTL_INSTRUMENT(OnAllocate, capacity_, sizeof(Type));
     }
 
-    SimpleVector(const SizeObjWrapper capacity_obj)
+    SimpleVector(const SizeObjWrapper capacity_obj CSTL_AND_SITE_PARAM)
         : capacity_(capacity_obj.Get())
+        , probe_(CSTL_SITE)
     {
     }
 
-    SimpleVector(const SimpleVector& other) {
-        SimpleVector<Type> tmp(other.size_);
+    SimpleVector(const SimpleVector& other CSTL_AND_SITE_PARAM) : probe_(CSTL_SITE) {
+        SimpleVector<Type> tmp(other.size_ CSTL_AND_NO_SITE);
         std::copy(other.begin(), other.end(), tmp.begin());
         swap(tmp);
     }
 
+    ~SimpleVector() {
+        if (elements_.Get())
+            CSTL_INSTRUMENT(OnDeallocate, capacity_, sizeof(Type));
+        probe_.OnDestroy(size_);
+    }
+
     SimpleVector& operator=(const SimpleVector& rhs) {
         if (begin() != rhs.begin()) {
-            SimpleVector rhs_copy(rhs);
+            SimpleVector rhs_copy(rhs CSTL_AND_NO_SITE);
             swap(rhs_copy);
         }
         return *this;
@@ -70,8 +96,9 @@ public:
     SimpleVector(SimpleVector&& other) 
         : capacity_(other.capacity_)
         , size_(other.size_)
+        , probe_(std::move(other.probe_))
     {
-        SimpleVector tmp(other.size_);
+        SimpleVector tmp(other.size_ CSTL_AND_NO_SITE);
         std::move(other.begin(), other.end(), tmp.begin());
 
         elements_.swap(tmp.elements_);
@@ -226,12 +253,16 @@ public:
 private:
     size_t capacity_{}, size_{};
     ArrayPtr<Type> elements_{};
+    [[no_unique_address]] profiling::CapacityProbe probe_;
 
     void Extend(const size_t new_capacity, const size_t new_size) {
         ArrayPtr<Type> new_elements(new_capacity);
         std::fill(new_elements.Get(), std::next(new_elements.Get(), new_size), 0);
 
         std::move(begin(), end(), new_elements.Get());
+        CSTL_INSTRUMENT(OnReallocate, elements_.Get() ? capacity_ : 0,
+                        new_capacity, size_, sizeof(Type));
+        probe_.OnGrowth();
         elements_.swap(new_elements);
 
         capacity_ = new_capacity;
@@ -245,14 +276,9 @@ private:
         else
             ++size_;
 
-        ArrayPtr<Type> tmp(size_);
-        std::move(begin(), &At(pos_index), tmp.Get());
-        std::move_backward(
-            &At(pos_index),
-            std::prev(end()),
-            std::next(tmp.Get(), size_)
-        );
-        elements_.swap(tmp);
+        // Every slot up to capacity_ holds a live element: shift the tail
+        // within the buffer
+        std::move_backward(&At(pos_index), std::prev(end()), end());
 
         return pos_index;
     }
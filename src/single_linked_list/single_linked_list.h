@@ -3,6 +3,8 @@
 #include <experimental/iterator>
 #include <iostream>
 
+#include "instrumentation/instrumentation.h"
+
 namespace cstl {
 
 template <typename Type>
@@ -173,6 +175,7 @@ public:
 
     void PushFront(const Type& value) {
         head_.next_node = new Node(value, head_.next_node);
+        CSTL_INSTRUMENT(OnAllocate, 1, sizeof(Node));
         ++size_;
     }
 
@@ -185,6 +188,7 @@ public:
             throw std::invalid_argument("pos argument points to nullptr");
 
         pos.node_->next_node = new Node(value, pos.node_->next_node);
+        CSTL_INSTRUMENT(OnAllocate, 1, sizeof(Node));
         ++size_;
         return Iterator{pos.node_->next_node};
     }
@@ -193,6 +197,7 @@ public:
         if (!IsEmpty()) {
             Node* next_node = head_.next_node->next_node;
             delete head_.next_node;
+            CSTL_INSTRUMENT(OnDeallocate, 1, sizeof(Node));
 
             head_.next_node = next_node;
             --size_;
@@ -210,6 +215,7 @@ public:
         Node* to_erase = pos.node_->next_node;
         pos.node_->next_node = to_erase->next_node;
         delete to_erase;
+        CSTL_INSTRUMENT(OnDeallocate, 1, sizeof(Node));
 
         --size_;
         return Iterator{pos.node_->next_node};
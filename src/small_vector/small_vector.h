@@ -0,0 +1,327 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "vector/uninitialized.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+// Vector keeping up to N elements inside the object itself. Once it outgrows
+// the inline buffer the elements move to a RawMemory heap buffer, which is
+// kept from then on. Assignment replaces the allocator only if it propagates.
+template <typename T,
+          size_t N,
+          typename Allocator = std::allocator<T>,
+          typename GrowthPolicy = DoublingGrowth<>>
+class SmallVector {
+    static_assert(N > 0, "use Vector for containers without inline storage");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+    using allocator_type = Allocator;
+    using growth_policy = GrowthPolicy;
+
+public:
+    SmallVector() = default;
+
+    explicit SmallVector(const Allocator& alloc) noexcept
+            : heap_(alloc) {
+    }
+
+    explicit SmallVector(const size_t size, const Allocator& alloc = Allocator())
+            : heap_(alloc) {
+        Resize(size);
+    }
+
+    SmallVector(const SmallVector& other)
+            : heap_(AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+        Reserve(other.size_);
+        detail::UninitializedCopyN(Alloc(), other.begin(), other.size_, begin());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(
+        std::is_nothrow_move_constructible_v<T>
+    )
+            : heap_(other.GetAllocator()) {
+        if (other.IsInline()) {
+            detail::UninitializedMoveN(Alloc(), other.begin(), other.size_, begin());
+            size_ = other.size_;
+            other.Clear();
+        } else {
+            heap_.Swap(other.heap_);
+            size_ = std::exchange(other.size_, 0);
+        }
+    }
+
+    // Elements are destroyed over [begin(), end()) rather than by count, here
+    // and below: a pointer-bounded loop keeps GCC -O3 from assuming a count
+    // of up to SIZE_MAX and flagging overflow in the element destructor
+    ~SmallVector() {
+        detail::Destroy(Alloc(), begin(), end());
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this == &rhs)
+            return *this;
+
+        Clear();
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            if (GetAllocator() != rhs.GetAllocator())
+                heap_.Reset(rhs.GetAllocator());
+        }
+        Reserve(rhs.size_);
+        detail::UninitializedCopyN(Alloc(), rhs.begin(), rhs.size_, begin());
+        size_ = rhs.size_;
+        return *this;
+    }
+
+    // Unequal allocators cannot take over rhs's heap buffer, and copying
+    // its elements may allocate
+    SmallVector& operator=(SmallVector&& rhs) noexcept(
+        std::is_nothrow_move_constructible_v<T>
+        && (AllocTraits::propagate_on_container_move_assignment::value
+            || AllocTraits::is_always_equal::value)
+    ) {
+        if (this == &rhs)
+            return *this;
+
+        Clear();
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            if (GetAllocator() != rhs.GetAllocator())
+                heap_.Reset(rhs.GetAllocator());
+        }
+        if (!rhs.IsInline() && GetAllocator() == rhs.GetAllocator()) {
+            heap_.Swap(rhs.heap_);
+            size_ = std::exchange(rhs.size_, 0);
+        } else {
+            Reserve(rhs.size_);
+            detail::UninitializedMoveN(Alloc(), rhs.begin(), rhs.size_, begin());
+            size_ = rhs.size_;
+            rhs.Clear();
+        }
+        return *this;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return begin()[index];
+    }
+
+    iterator begin() noexcept {
+        return IsInline() ? std::launder(reinterpret_cast<T*>(inline_)) : heap_.GetAddress();
+    }
+
+    iterator end() noexcept {
+        return begin() + size_;
+    }
+
+    const_iterator begin() const noexcept {
+        return const_cast<SmallVector&>(*this).begin();
+    }
+
+    const_iterator end() const noexcept {
+        return begin() + size_;
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    void Swap(SmallVector& other) {
+        if (!IsInline() && !other.IsInline()) {
+            heap_.Swap(other.heap_);
+            std::swap(size_, other.size_);
+        } else {
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+        std::swap(growth_, other.growth_);
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    // True while the elements live in the inline buffer
+    bool IsInline() const noexcept {
+        return heap_.Capacity() == 0;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity())
+            return;
+
+        RawMemory<T, Allocator> new_data(new_capacity, GetAllocator());
+        UninitializedCopyOrMoveN(new_data.GetAllocator(), begin(), size_, new_data.GetAddress());
+        DestroyAndAdopt(std::move(new_data));
+    }
+
+    void Resize(size_t new_size) {
+        Reserve(new_size);
+
+        if (size_ < new_size)
+            detail::UninitializedValueConstructN(Alloc(), end(), new_size - size_);
+        else
+            detail::Destroy(Alloc(), begin() + new_size, end());
+        size_ = new_size;
+    }
+
+    void Clear() noexcept {
+        detail::Destroy(Alloc(), begin(), end());
+        size_ = 0;
+    }
+
+    void PopBack() {
+        assert(size_);
+
+        detail::DestroyAt(Alloc(), begin() + size_ - 1);
+        --size_;
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(pos >= begin() && pos < end());
+
+        size_t index = pos - begin();
+        if constexpr (is_trivially_relocatable_v<T>) {
+            detail::DestroyAt(Alloc(), begin() + index);
+            detail::RelocateWithin(begin() + index + 1, size_ - index - 1, begin() + index);
+            --size_;
+            return std::next(begin(), index);
+        }
+
+        std::move(std::next(begin(), index + 1), end(), std::next(begin(), index));
+        PopBack();
+
+        return std::next(begin(), index);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    inline iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    inline iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity())
+            EmplaceWithRealloc(size_, std::forward<Args>(args)...);
+        else
+            detail::ConstructAt(Alloc(), end(), std::forward<Args>(args)...);
+        return begin()[size_++];
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= begin() && pos <= end());
+
+        size_t index = pos - begin();
+        if (size_ == Capacity()) {
+            EmplaceWithRealloc(index, std::forward<Args>(args)...);
+        } else if (index == size_) {
+            detail::ConstructAt(Alloc(), end(), std::forward<Args>(args)...);
+        } else if constexpr (is_trivially_relocatable_v<T>) {
+            // Build the element aside first: args may refer into the tail
+            detail::Uninitialized<T> tmp;
+            detail::ConstructAt(Alloc(), &tmp.value, std::forward<Args>(args)...);
+
+            detail::RelocateWithin(begin() + index, size_ - index, begin() + index + 1);
+            detail::Relocate(&tmp.value, 1, begin() + index);
+        } else {
+            T tmp = std::make_obj_using_allocator<T>(GetAllocator(), std::forward<Args>(args)...);
+
+            detail::ConstructAt(Alloc(), end(), std::move(begin()[size_ - 1u]));
+            std::move_backward(begin() + index, std::prev(end()), end());
+            begin()[index] = std::move(tmp);
+        }
+
+        ++size_;
+        return std::next(begin(), index);
+    }
+
+private:
+    alignas(T) std::byte inline_[N*sizeof(T)];
+    RawMemory<T, Allocator> heap_;
+    size_t size_ = 0;
+    [[no_unique_address]] GrowthPolicy growth_{};
+
+    Allocator& Alloc() noexcept {
+        return heap_.GetAllocator();
+    }
+
+    // Reallocates leaving a constructed element at `index`; the element is
+    // built before anything moves, so args may refer to elements of *this
+    template <typename... Args>
+    void EmplaceWithRealloc(size_t index, Args&&... args) {
+        RawMemory<T, Allocator> new_data(
+            growth_.NextCapacity(Capacity(), size_ + 1, sizeof(T)),
+            GetAllocator()
+        );
+        detail::ConstructAt(new_data.GetAllocator(), new_data + index,
+                            std::forward<Args>(args)...);
+
+        UninitializedCopyOrMoveN(new_data.GetAllocator(), begin(), index,
+                                 new_data.GetAddress());
+        UninitializedCopyOrMoveN(
+            new_data.GetAllocator(),
+            begin() + index,
+            size_ - index,
+            new_data.GetAddress() + index + 1
+        );
+        DestroyAndAdopt(std::move(new_data));
+    }
+
+    static void UninitializedCopyOrMoveN(Allocator& alloc, T* first, size_t count, T* d_first) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            detail::Relocate(first, count, d_first);
+        } else if constexpr (std::is_nothrow_move_constructible_v<T>
+                             || !std::is_copy_constructible_v<T>) {
+            detail::UninitializedMoveN(alloc, first, count, d_first);
+        } else {
+            detail::UninitializedCopyN(alloc, first, count, d_first);
+        }
+    }
+
+    inline void DestroyAndAdopt(RawMemory<T, Allocator>&& new_data) {
+        if constexpr (!is_trivially_relocatable_v<T>)
+            detail::Destroy(Alloc(), begin(), end());
+        heap_.Swap(new_data);
+    }
+};
+
+} // namespace cstl
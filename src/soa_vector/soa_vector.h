@@ -0,0 +1,398 @@
+#pragma once
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "vector/index_iterator.h"
+#include "vector/uninitialized.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+// Structure-of-arrays vector: record i is (column<0>[i], column<1>[i], ...),
+// each column a RawMemory of one field type, all sharing one size. Loops
+// over one field read only that field's column, and Column<I>() exposes it
+// as a contiguous span for vectorized kernels.
+//
+// Indexing and iterators yield a proxy Reference to the fields of a record.
+// It converts to and assigns from value_type (a tuple of the fields),
+// supports get<I>() and structured bindings, and swaps the fields of two
+// records, so STL algorithms including std::sort work on the iterators.
+//
+// The columns always use std::allocator. An Allocator parameter cannot
+// follow the Fields pack, and one allocator would have to be rebound to
+// every field type. Containers that need one should use Vector per field.
+template <typename... Fields>
+class SoAVector;
+
+// Proxy for the fields of one SoAVector record
+template <bool IsConst, typename... Fields>
+class SoAReference {
+    template <typename...>
+    friend class SoAVector;
+
+    using Refs = std::conditional_t<
+        IsConst,
+        std::tuple<const Fields&...>,
+        std::tuple<Fields&...>
+    >;
+    using Indices = std::index_sequence_for<Fields...>;
+
+    explicit SoAReference(Refs refs) noexcept
+        : refs_(refs)
+    {
+    }
+
+public:
+    using value_type = std::tuple<Fields...>;
+
+    SoAReference(const SoAReference&) = default;
+
+    SoAReference(const SoAReference<false, Fields...>& other) noexcept
+    requires (IsConst)
+        : refs_(other.refs_)
+    {
+    }
+
+    // Assignments write through to the referenced fields
+    const SoAReference& operator=(const SoAReference& rhs) const
+    requires (!IsConst) {
+        Assign(rhs.refs_, Indices{});
+        return *this;
+    }
+
+    const SoAReference& operator=(const value_type& rhs) const
+    requires (!IsConst) {
+        Assign(rhs, Indices{});
+        return *this;
+    }
+
+    const SoAReference& operator=(value_type&& rhs) const
+    requires (!IsConst) {
+        Assign(std::move(rhs), Indices{});
+        return *this;
+    }
+
+    template <size_t I>
+    auto& Get() const noexcept {
+        return std::get<I>(refs_);
+    }
+
+    template <size_t I>
+    friend auto& get(const SoAReference& ref) noexcept {
+        return ref.template Get<I>();
+    }
+
+    operator value_type() const {
+        return std::make_from_tuple<value_type>(refs_);
+    }
+
+    friend void swap(const SoAReference& lhs, const SoAReference& rhs)
+    requires (!IsConst) {
+        lhs.SwapFields(rhs, Indices{});
+    }
+
+    friend bool operator==(const SoAReference& lhs, const value_type& rhs) {
+        return lhs.refs_ == rhs;
+    }
+
+    template <bool OtherConst>
+    friend bool operator==(const SoAReference& lhs,
+                           const SoAReference<OtherConst, Fields...>& rhs) {
+        return lhs.refs_ == rhs.refs_;
+    }
+
+private:
+    Refs refs_;
+
+    template <typename Tuple, size_t... I>
+    void Assign(Tuple&& rhs, std::index_sequence<I...>) const {
+        ((std::get<I>(refs_) = std::get<I>(std::forward<Tuple>(rhs))), ...);
+    }
+
+    template <size_t... I>
+    void SwapFields(const SoAReference& other, std::index_sequence<I...>) const {
+        using std::swap;
+        (swap(std::get<I>(refs_), std::get<I>(other.refs_)), ...);
+    }
+
+    template <bool, typename...>
+    friend class SoAReference;
+};
+
+template <typename... Fields>
+class SoAVector {
+    static_assert(sizeof...(Fields) > 0, "a record needs at least one field");
+    static_assert((std::is_nothrow_move_constructible_v<Fields> && ...),
+                  "columns are relocated without rollback");
+
+    using Columns = std::tuple<RawMemory<Fields>...>;
+    using Indices = std::index_sequence_for<Fields...>;
+
+    static constexpr size_t RECORD_SIZE = (sizeof(Fields) + ...);
+
+public:
+    using value_type = std::tuple<Fields...>;
+
+    template <size_t I>
+    using field_type = std::tuple_element_t<I, value_type>;
+
+    using reference = SoAReference<false, Fields...>;
+    using const_reference = SoAReference<true, Fields...>;
+
+private:
+    template <bool IsConst>
+    struct IteratorAccess {
+        using Container = SoAVector;
+        using Handle = std::conditional_t<IsConst, const SoAVector*, SoAVector*>;
+        using value_type = SoAVector::value_type;
+        using pointer = void;
+        using reference = SoAReference<IsConst, Fields...>;
+
+        static reference Get(Handle soa, size_t index) noexcept {
+            return (*soa)[index];
+        }
+    };
+
+public:
+    using iterator = detail::IndexIterator<IteratorAccess, false>;
+    using const_iterator = detail::IndexIterator<IteratorAccess, true>;
+
+public:
+    SoAVector() = default;
+
+    // Delegating first makes ~SoAVector destroy the records already built
+    // if a later one throws
+    explicit SoAVector(size_t size)
+            : SoAVector() {
+        Resize(size);
+    }
+
+    SoAVector(const SoAVector& other)
+            : SoAVector() {
+        Reserve(other.size_);
+        for (size_t i = 0; i < other.size_; ++i)
+            EmplaceBackFrom(other, i, Indices{});
+    }
+
+    SoAVector(SoAVector&& other) noexcept
+            : columns_(std::move(other.columns_))
+            , size_(std::exchange(other.size_, 0)) {
+    }
+
+    ~SoAVector() {
+        Clear();
+    }
+
+    SoAVector& operator=(const SoAVector& rhs) {
+        if (this != &rhs) {
+            SoAVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SoAVector& operator=(SoAVector&& rhs) noexcept {
+        Swap(rhs);
+        return *this;
+    }
+
+    reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return RecordAt<reference>(*this, index, Indices{});
+    }
+
+    const_reference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return RecordAt<const_reference>(*this, index, Indices{});
+    }
+
+    // Field I of all records
+    template <size_t I>
+    std::span<field_type<I>> Column() noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    template <size_t I>
+    std::span<const field_type<I>> Column() const noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+    void Swap(SoAVector& other) noexcept {
+        SwapColumns(other.columns_, Indices{});
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return std::get<0>(columns_).Capacity();
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity())
+            return;
+
+        Columns new_columns{RawMemory<Fields>(new_capacity)...};
+        RelocateInto(new_columns, Indices{});
+    }
+
+    void Resize(size_t new_size) {
+        Reserve(new_size);
+
+        while (size_ < new_size)
+            EmplaceBack(Fields()...);
+        while (size_ > new_size)
+            PopBack();
+    }
+
+    void Clear() noexcept {
+        while (size_)
+            PopBack();
+    }
+
+    void PushBack(const value_type& record) {
+        std::apply([this](const Fields&... fields) {
+            EmplaceBack(fields...);
+        }, record);
+    }
+
+    void PushBack(value_type&& record) {
+        std::apply([this](Fields&... fields) {
+            EmplaceBack(std::move(fields)...);
+        }, record);
+    }
+
+    // Builds field I of the new record from args[I]
+    template <typename... Args>
+    reference EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Fields),
+                      "one argument per field");
+
+        if (size_ == Capacity()) {
+            // The record is built first: args may refer into the old columns
+            const size_t new_capacity
+                = growth_.NextCapacity(Capacity(), size_ + 1, RECORD_SIZE);
+            Columns new_columns{RawMemory<Fields>(new_capacity)...};
+            ConstructRecord(new_columns, size_, Indices{}, std::forward<Args>(args)...);
+            RelocateInto(new_columns, Indices{});
+        } else {
+            ConstructRecord(columns_, size_, Indices{}, std::forward<Args>(args)...);
+        }
+        return (*this)[size_++];
+    }
+
+    void PopBack() noexcept {
+        assert(size_);
+
+        --size_;
+        DestroyRecord(size_, Indices{});
+    }
+
+private:
+    Columns columns_;
+    size_t size_ = 0;
+    [[no_unique_address]] DoublingGrowth<> growth_{};
+
+    template <typename Reference, typename Self, size_t... I>
+    static Reference RecordAt(Self& self, size_t index, std::index_sequence<I...>) noexcept {
+        return Reference(typename Reference::Refs(std::get<I>(self.columns_)[index]...));
+    }
+
+    template <size_t... I>
+    void EmplaceBackFrom(const SoAVector& other, size_t index, std::index_sequence<I...>) {
+        EmplaceBack(std::get<I>(other.columns_)[index]...);
+    }
+
+    // Constructs the fields of record `index` in `columns`, destroying the
+    // ones already built if a later one throws
+    template <size_t... I, typename... Args>
+    static void ConstructRecord(Columns& columns, size_t index,
+                                std::index_sequence<I...>, Args&&... args) {
+        size_t constructed = 0;
+        try {
+            ((new (std::get<I>(columns) + index) Fields(std::forward<Args>(args)),
+              ++constructed), ...);
+        } catch (...) {
+            ((I < constructed ? std::destroy_at(std::get<I>(columns) + index) : void()), ...);
+            throw;
+        }
+    }
+
+    template <size_t... I>
+    void DestroyRecord(size_t index, std::index_sequence<I...>) noexcept {
+        (std::destroy_at(std::get<I>(columns_) + index), ...);
+    }
+
+    // Moves the records into `new_columns` (which may already hold record
+    // size_) and adopts them
+    template <size_t... I>
+    void RelocateInto(Columns& new_columns, std::index_sequence<I...>) noexcept {
+        (RelocateColumn(std::get<I>(columns_), std::get<I>(new_columns)), ...);
+        SwapColumns(new_columns, Indices{});
+    }
+
+    template <typename T>
+    void RelocateColumn(RawMemory<T>& from, RawMemory<T>& to) noexcept {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            detail::Relocate(from.GetAddress(), size_, to.GetAddress());
+        } else {
+            detail::UninitializedMoveN(from.GetAddress(), size_, to.GetAddress());
+            std::destroy_n(from.GetAddress(), size_);
+        }
+    }
+
+    template <size_t... I>
+    void SwapColumns(Columns& other, std::index_sequence<I...>) noexcept {
+        (std::get<I>(columns_).Swap(std::get<I>(other)), ...);
+    }
+};
+
+} // namespace cstl
+
+// Structured bindings over a record: auto [a, b] = soa[i];
+template <bool IsConst, typename... Fields>
+struct std::tuple_size<cstl::SoAReference<IsConst, Fields...>>
+    : std::integral_constant<size_t, sizeof...(Fields)> {};
+
+template <size_t I, bool IsConst, typename... Fields>
+struct std::tuple_element<I, cstl::SoAReference<IsConst, Fields...>> {
+    using type = std::conditional_t<
+        IsConst,
+        const std::tuple_element_t<I, std::tuple<Fields...>>,
+        std::tuple_element_t<I, std::tuple<Fields...>>
+    >&;
+};
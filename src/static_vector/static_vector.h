@@ -0,0 +1,336 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector/uninitialized.h"
+#include "vector/vector.h"
+
+namespace cstl {
+
+// What a StaticVector does when an insertion does not fit:
+// - Throw: throws std::length_error;
+// - ReturnFalse: leaves the vector unchanged and reports it through the
+//   result (false, nullptr or end(), see below);
+// - Assert: a precondition checked with assert() only, for callers that
+//   know the bound; overflowing an NDEBUG build is undefined behaviour.
+// Constructors cannot report anything, so with ReturnFalse they assert.
+enum class OnFull {
+    Throw,
+    ReturnFalse,
+    Assert,
+};
+
+// Vector with room for N elements inside the object and no allocation at
+// all. For trivially copyable T it is trivially copyable itself (the storage
+// and the size), so it can be placed in shared memory or copied bytewise.
+template <typename T, size_t N, OnFull Full = OnFull::Throw>
+class StaticVector {
+    static_assert(N > 0, "a StaticVector needs room for an element");
+
+    static constexpr bool TRIVIAL = std::is_trivially_copyable_v<T>;
+    static constexpr bool REPORTS = Full == OnFull::ReturnFalse;
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+    // EmplaceBack returns a pointer, null when full, under ReturnFalse
+    using emplace_result = std::conditional_t<REPORTS, T*, T&>;
+
+    static constexpr OnFull on_full = Full;
+
+public:
+    StaticVector() noexcept {
+    }
+
+    explicit StaticVector(const size_t size) {
+        [[maybe_unused]] const bool fits = Resize(size);
+        assert(fits);
+    }
+
+    StaticVector(const StaticVector&) requires TRIVIAL = default;
+
+    StaticVector(const StaticVector& other) {
+        std::uninitialized_copy_n(other.begin(), other.size_, begin());
+        size_ = other.size_;
+    }
+
+    StaticVector(StaticVector&&) requires TRIVIAL = default;
+
+    // Moves the elements one by one; `other` is left empty
+    StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        std::uninitialized_move_n(other.begin(), other.size_, begin());
+        size_ = other.size_;
+        other.Clear();
+    }
+
+    ~StaticVector() requires TRIVIAL = default;
+
+    ~StaticVector() {
+        std::destroy_n(begin(), size_);
+    }
+
+    StaticVector& operator=(const StaticVector&) requires TRIVIAL = default;
+
+    StaticVector& operator=(const StaticVector& rhs) {
+        if (this != &rhs)
+            AssignElements(rhs.begin(), rhs.size_);
+        return *this;
+    }
+
+    StaticVector& operator=(StaticVector&&) requires TRIVIAL = default;
+
+    StaticVector& operator=(StaticVector&& rhs) noexcept(
+        std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>
+    ) {
+        if (this != &rhs) {
+            AssignElements(std::make_move_iterator(rhs.begin()), rhs.size_);
+            rhs.Clear();
+        }
+        return *this;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<StaticVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return begin()[index];
+    }
+
+    iterator begin() noexcept {
+        return std::launder(reinterpret_cast<T*>(storage_));
+    }
+
+    iterator end() noexcept {
+        return begin() + size_;
+    }
+
+    const_iterator begin() const noexcept {
+        return const_cast<StaticVector&>(*this).begin();
+    }
+
+    const_iterator end() const noexcept {
+        return begin() + size_;
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    void Swap(StaticVector& other) {
+        StaticVector& longer = size_ < other.size_ ? other : *this;
+        StaticVector& shorter = size_ < other.size_ ? *this : other;
+
+        std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+        std::uninitialized_move(longer.begin() + shorter.size_, longer.end(), shorter.end());
+        std::destroy(longer.begin() + shorter.size_, longer.end());
+        std::swap(size_, other.size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    bool IsFull() const noexcept {
+        return size_ == N;
+    }
+
+    // Returns false if new_size exceeds N (under ReturnFalse)
+    bool Resize(size_t new_size) {
+        if (new_size > size_) {
+            if (!HasRoom(new_size - size_))
+                return false;
+            std::uninitialized_value_construct_n(end(), new_size - size_);
+        } else {
+            std::destroy_n(begin() + new_size, size_ - new_size);
+        }
+        size_ = new_size;
+        return true;
+    }
+
+    void Clear() noexcept {
+        std::destroy_n(begin(), size_);
+        size_ = 0;
+    }
+
+    void PopBack() {
+        assert(size_);
+
+        std::destroy_at(begin() + size_ - 1);
+        --size_;
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(pos >= begin() && pos < end());
+        return Erase(pos, pos + 1);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        assert(first >= begin() && first <= last && last <= end());
+
+        const size_t index = first - begin();
+        const size_t count = last - first;
+        if constexpr (is_trivially_relocatable_v<T>) {
+            std::destroy_n(begin() + index, count);
+            detail::RelocateWithin(
+                begin() + index + count,
+                size_ - index - count,
+                begin() + index
+            );
+        } else {
+            std::move(begin() + index + count, end(), begin() + index);
+            std::destroy_n(end() - count, count);
+        }
+        size_ -= count;
+
+        return begin() + index;
+    }
+
+    // Returns false if full (under ReturnFalse)
+    bool PushBack(const T& value) {
+        return PushBackImpl(value);
+    }
+
+    bool PushBack(T&& value) {
+        return PushBackImpl(std::move(value));
+    }
+
+    // Under ReturnFalse these return end() if full
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Insert(const_iterator pos, size_t count, const T& value) {
+        assert(pos >= begin() && pos <= end());
+
+        const size_t index = pos - begin();
+        if (!HasRoom(count))
+            return end();
+
+        // value may refer to an element that is about to move
+        const T tmp(value);
+        if constexpr (is_trivially_relocatable_v<T>) {
+            detail::RelocateWithin(begin() + index, size_ - index, begin() + index + count);
+            try {
+                std::uninitialized_fill_n(begin() + index, count, tmp);
+            } catch (...) {
+                detail::RelocateWithin(begin() + index + count, size_ - index, begin() + index);
+                throw;
+            }
+            size_ += count;
+        } else {
+            std::uninitialized_fill_n(end(), count, tmp);
+            size_ += count;
+            std::rotate(begin() + index, end() - count, end());
+        }
+        return begin() + index;
+    }
+
+    template <typename... Args>
+    emplace_result EmplaceBack(Args&&... args) {
+        if (!HasRoom(1)) {
+            if constexpr (REPORTS)
+                return nullptr;
+        }
+
+        T* element = std::construct_at(end(), std::forward<Args>(args)...);
+        ++size_;
+        if constexpr (REPORTS)
+            return element;
+        else
+            return *element;
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= begin() && pos <= end());
+
+        const size_t index = pos - begin();
+        if (!HasRoom(1))
+            return end();
+
+        if (index == size_) {
+            std::construct_at(end(), std::forward<Args>(args)...);
+        } else if constexpr (is_trivially_relocatable_v<T>) {
+            // Build the element aside first: args may refer into the tail
+            detail::Uninitialized<T> tmp;
+            std::construct_at(&tmp.value, std::forward<Args>(args)...);
+
+            detail::RelocateWithin(begin() + index, size_ - index, begin() + index + 1);
+            detail::Relocate(&tmp.value, 1, begin() + index);
+        } else {
+            T tmp = T(std::forward<Args>(args)...);
+
+            std::construct_at(end(), std::move(begin()[size_ - 1]));
+            std::move_backward(begin() + index, end() - 1, end());
+            begin()[index] = std::move(tmp);
+        }
+
+        ++size_;
+        return begin() + index;
+    }
+
+private:
+    alignas(T) std::byte storage_[N*sizeof(T)];
+    size_t size_ = 0;
+
+    // Whether `count` more elements fit; otherwise throws, asserts or
+    // returns false as Full says
+    bool HasRoom([[maybe_unused]] size_t count) const {
+        if constexpr (Full == OnFull::Assert) {
+            assert(count <= N - size_ && "StaticVector capacity exceeded");
+            return true;
+        } else {
+            if (count <= N - size_) [[likely]]
+                return true;
+            if constexpr (Full == OnFull::Throw)
+                throw std::length_error("StaticVector capacity exceeded");
+            return false;
+        }
+    }
+
+    template <typename U>
+    bool PushBackImpl(U&& value) {
+        if constexpr (REPORTS) {
+            return EmplaceBack(std::forward<U>(value)) != nullptr;
+        } else {
+            EmplaceBack(std::forward<U>(value));
+            return true;
+        }
+    }
+
+    template <typename InputIt>
+    void AssignElements(InputIt first, size_t count) {
+        const size_t common = std::min(size_, count);
+        std::copy_n(first, common, begin());
+        if (count > size_)
+            std::uninitialized_copy_n(std::next(first, common), count - common, end());
+        else
+            std::destroy_n(begin() + count, size_ - count);
+        size_ = count;
+    }
+};
+
+} // namespace cstl
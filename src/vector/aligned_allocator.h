@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include "vector.h"
+
+namespace cstl {
+
+// Allocator returning buffers aligned to Alignment bytes, e.g. a cache line
+// or a SIMD register. With PadToLanes the capacity is rounded up to a whole
+// number of Alignment-sized lanes, so SIMD loops may run to the padded end
+// without a scalar remainder loop.
+template <typename T, size_t Alignment, bool PadToLanes = false>
+class AlignedAllocator {
+    static_assert(Alignment && (Alignment & (Alignment - 1)) == 0,
+                  "alignment must be a power of two");
+    static_assert(Alignment >= alignof(T),
+                  "alignment must not be weaker than the type's own");
+
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment, PadToLanes>;
+    };
+
+    static constexpr size_t alignment = Alignment;
+
+public:
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment, PadToLanes>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(
+            ::operator new(n*sizeof(T), std::align_val_t{Alignment})
+        );
+    }
+
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        const size_t count = PadToLanes ? PaddedCount(n) : n;
+        return {allocate(count), count};
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        ::operator delete(p, std::align_val_t{Alignment});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment, PadToLanes>&) const noexcept {
+        return true;
+    }
+
+    // Number of elements filling whole lanes that hold at least n elements
+    static constexpr size_t PaddedCount(size_t n) noexcept {
+        const size_t bytes = (n*sizeof(T) + Alignment - 1)/Alignment*Alignment;
+        return bytes/sizeof(T);
+    }
+};
+
+// Vector whose begin() is aligned to Alignment bytes
+template <typename T, size_t Alignment, bool PadToLanes = false>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment, PadToLanes>>;
+
+} // namespace cstl
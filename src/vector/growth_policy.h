@@ -0,0 +1,115 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+
+namespace cstl {
+
+// A growth policy decides the capacity a container reallocates to once it
+// runs out of room. Any type with a member
+//     size_t NextCapacity(size_t capacity, size_t required, size_t element_size)
+// returning at least `required` can be plugged in; policies may keep state.
+// A policy may also define
+//     size_t ShrinkCapacity(size_t capacity, size_t size, size_t element_size)
+// which Vector calls after removing elements; returning less than
+// `capacity` makes it reallocate down to that capacity.
+
+// ---------- GeometricGrowth ---------
+
+// Multiplies the capacity by Numerator/Denominator, starting from MinCapacity
+template <size_t Numerator, size_t Denominator, size_t MinCapacity = 1>
+struct GeometricGrowth {
+    static_assert(Numerator > Denominator && Denominator > 0,
+                  "growth factor must be greater than 1");
+
+    // Two-argument std::max keeps `result >= required` visible to GCC; through
+    // the initializer_list overload it assumes a zero capacity is possible
+    // and warns about writes into the empty buffer
+    constexpr size_t NextCapacity(size_t capacity, size_t required, size_t) const noexcept {
+        return std::max(std::max(MinCapacity, capacity*Numerator/Denominator), required);
+    }
+};
+
+template <size_t MinCapacity = 1>
+using DoublingGrowth = GeometricGrowth<2, 1, MinCapacity>;
+
+template <size_t MinCapacity = 1>
+using OneAndHalfGrowth = GeometricGrowth<3, 2, MinCapacity>;
+
+// ---------- ExactGrowth -------------
+
+// Allocates only what is required: minimal memory, a reallocation per growth
+template <size_t MinCapacity = 1>
+struct ExactGrowth {
+    constexpr size_t NextCapacity(size_t, size_t required, size_t) const noexcept {
+        return std::max(MinCapacity, required);
+    }
+};
+
+// ---------- SizeClassGrowth ---------
+
+// Rounds the capacity proposed by Base up to the allocation size the
+// allocator would hand out anyway: jemalloc-like size classes (four per
+// doubling) for small buffers and whole pages for large ones. The slack at
+// the end of the block then becomes usable capacity instead of waste.
+template <typename Base = DoublingGrowth<>, size_t PageSize = 4096>
+struct SizeClassGrowth {
+    static_assert(PageSize && (PageSize & (PageSize - 1)) == 0,
+                  "page size must be a power of two");
+
+    [[no_unique_address]] Base base{};
+
+    constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) {
+        const size_t proposed = base.NextCapacity(capacity, required, element_size);
+        const size_t bytes = RoundUp(proposed*element_size);
+        return std::max(proposed, bytes/element_size);
+    }
+
+    static constexpr size_t RoundUp(size_t bytes) noexcept {
+        const size_t quantum = 16;
+        if (bytes <= 8*quantum)
+            return (bytes + quantum - 1) & ~(quantum - 1);
+        if (bytes >= PageSize)
+            return (bytes + PageSize - 1) & ~(PageSize - 1);
+
+        // Four classes between consecutive powers of two
+        size_t group = 8*quantum;
+        while (group*2 < bytes)
+            group *= 2;
+        const size_t step = group/4;
+        return (bytes + step - 1)/step*step;
+    }
+};
+
+// ---------- ReclaimingGrowth --------
+
+// Grows like Base and hands memory back after a burst: once removals have
+// left the size below capacity/Divisor Patience times in a row, the vector
+// reallocates down to twice its size. Shrinking only well below the new
+// capacity's growth point keeps it from oscillating between the two.
+template <typename Base = DoublingGrowth<>, size_t Divisor = 4, size_t Patience = 16>
+struct ReclaimingGrowth {
+    static_assert(Divisor > 2, "shrinking to twice the size must free memory");
+    static_assert(Patience > 0);
+
+    [[no_unique_address]] Base base{};
+    size_t low_streak = 0;
+
+    constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) {
+        low_streak = 0;
+        return base.NextCapacity(capacity, required, element_size);
+    }
+
+    constexpr size_t ShrinkCapacity(size_t capacity, size_t size, size_t) noexcept {
+        if (size*Divisor >= capacity) {
+            low_streak = 0;
+            return capacity;
+        }
+        if (++low_streak < Patience)
+            return capacity;
+
+        low_streak = 0;
+        return size*2;
+    }
+};
+
+} // namespace cstl
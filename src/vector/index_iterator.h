@@ -0,0 +1,153 @@
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace cstl::detail {
+
+// `pointer` of an iterator whose reference is a proxy object: keeps the proxy
+// alive for the duration of `it->member`
+template <typename Reference>
+struct ArrowProxy {
+    Reference reference;
+
+    Reference* operator->() noexcept {
+        return &reference;
+    }
+};
+
+// Random-access iterator that is an index into a container plus a handle
+// (e.g. a pointer to the container) to reach the element there. Containers
+// differ only in how an index is dereferenced, which they describe with a
+// class template Access<IsConst> providing
+//     using Container = ...;   // may construct iterators and read handle_
+//     using Handle = ...;      // copied into every iterator
+//     using value_type = ..., reference = ..., pointer = ...;
+//     static reference Get(Handle handle, size_t index) noexcept;
+// iterator and const_iterator are then IndexIterator<Access, false> and
+// IndexIterator<Access, true>. Iterators compare by index alone.
+template <template <bool> typename Access, bool IsConst>
+class IndexIterator {
+    using Traits = Access<IsConst>;
+    using Handle = typename Traits::Handle;
+
+    friend typename Traits::Container;
+
+    IndexIterator(Handle handle, size_t index) noexcept
+        : handle_(handle)
+        , index_(index)
+    {
+    }
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename Traits::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = typename Traits::pointer;
+    using reference = typename Traits::reference;
+
+    IndexIterator() = default;
+
+    IndexIterator(const IndexIterator&) = default;
+
+    IndexIterator(const IndexIterator<Access, false>& other) noexcept
+    requires (IsConst)
+        : handle_(other.handle_)
+        , index_(other.index_)
+    {
+    }
+
+    IndexIterator& operator=(const IndexIterator&) = default;
+
+    [[nodiscard]] reference operator*() const noexcept {
+        return Traits::Get(handle_, index_);
+    }
+
+    // Only for containers whose references are real references, or whose
+    // pointer is an ArrowProxy
+    [[nodiscard]] pointer operator->() const noexcept
+    requires (!std::is_void_v<pointer>) {
+        if constexpr (std::is_pointer_v<pointer>)
+            return &**this;
+        else
+            return pointer{**this};
+    }
+
+    [[nodiscard]] reference operator[](difference_type n) const noexcept {
+        return Traits::Get(handle_, index_ + n);
+    }
+
+    // Index of the element, e.g. into the columns of the container
+    [[nodiscard]] size_t Index() const noexcept {
+        return index_;
+    }
+
+    IndexIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    IndexIterator operator++(int) noexcept {
+        IndexIterator old_value(*this);
+        ++index_;
+        return old_value;
+    }
+
+    IndexIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    IndexIterator operator--(int) noexcept {
+        IndexIterator old_value(*this);
+        --index_;
+        return old_value;
+    }
+
+    IndexIterator& operator+=(difference_type n) noexcept {
+        index_ += n;
+        return *this;
+    }
+
+    IndexIterator& operator-=(difference_type n) noexcept {
+        index_ -= n;
+        return *this;
+    }
+
+    [[nodiscard]] friend IndexIterator operator+(IndexIterator it, difference_type n) noexcept {
+        return it += n;
+    }
+
+    [[nodiscard]] friend IndexIterator operator+(difference_type n, IndexIterator it) noexcept {
+        return it += n;
+    }
+
+    [[nodiscard]] friend IndexIterator operator-(IndexIterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+
+    [[nodiscard]] friend difference_type operator-(const IndexIterator& lhs,
+                                                   const IndexIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_)
+               - static_cast<difference_type>(rhs.index_);
+    }
+
+    [[nodiscard]] friend bool operator==(const IndexIterator& lhs,
+                                         const IndexIterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    [[nodiscard]] friend auto operator<=>(const IndexIterator& lhs,
+                                          const IndexIterator& rhs) noexcept {
+        return lhs.index_ <=> rhs.index_;
+    }
+
+private:
+    Handle handle_{};
+    size_t index_ = 0;
+
+    friend class IndexIterator<Access, !IsConst>;
+};
+
+} // namespace cstl::detail
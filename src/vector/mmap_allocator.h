@@ -0,0 +1,99 @@
+#pragma once
+#if defined(__linux__)
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "vector.h"
+
+namespace cstl {
+
+// Allocator handing out anonymous private mappings. Its reallocate() grows a
+// buffer with mremap(MREMAP_MAYMOVE), which remaps the pages instead of
+// copying them; Vector uses it for trivially relocatable elements, so growth
+// neither copies bytes nor needs old and new buffers at once. Every buffer
+// takes at least a page, so it pays off only for large vectors. With
+// HugePages the mapping is advised to be backed by transparent huge pages.
+// allocate_at_least() hands the rest of the last page to the caller.
+template <typename T, bool HugePages = false>
+class MmapAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = MmapAllocator<U, HugePages>;
+    };
+
+public:
+    MmapAllocator() noexcept = default;
+
+    template <typename U>
+    MmapAllocator(const MmapAllocator<U, HugePages>&) noexcept {}
+
+    T* allocate(size_t n) {
+        void* p = mmap(nullptr, Bytes(n), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+
+        Advise(p, n);
+        return static_cast<T*>(p);
+    }
+
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        const size_t count = Bytes(n)/sizeof(T);
+        return {allocate(count), count};
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        munmap(p, Bytes(n));
+    }
+
+    // Keeps the first min(old_n, new_n) elements' bytes, possibly at a new
+    // address
+    T* reallocate(T* p, size_t old_n, size_t new_n) {
+        if (Bytes(old_n) == Bytes(new_n))
+            return p;
+
+        void* new_p = mremap(p, Bytes(old_n), Bytes(new_n), MREMAP_MAYMOVE);
+        if (new_p == MAP_FAILED)
+            throw std::bad_alloc();
+
+        Advise(new_p, new_n);
+        return static_cast<T*>(new_p);
+    }
+
+    template <typename U>
+    bool operator==(const MmapAllocator<U, HugePages>&) const noexcept {
+        return true;
+    }
+
+    // Mapping granularity: a page, or a huge page if requested
+    static size_t Granularity() noexcept {
+        static const size_t page_size = HugePages
+            ? size_t{2} << 20
+            : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page_size;
+    }
+
+private:
+    static size_t Bytes(size_t n) noexcept {
+        const size_t granularity = Granularity();
+        return (n*sizeof(T) + granularity - 1)/granularity*granularity;
+    }
+
+    static void Advise([[maybe_unused]] void* p, [[maybe_unused]] size_t n) noexcept {
+#if defined(MADV_HUGEPAGE)
+        if constexpr (HugePages)
+            madvise(p, Bytes(n), MADV_HUGEPAGE);
+#endif
+    }
+};
+
+} // namespace cstl
+#endif
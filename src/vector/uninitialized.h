@@ -0,0 +1,278 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace cstl {
+
+// Selects default- instead of value-initialisation: trivial elements are left
+// uninitialised rather than zeroed
+struct DefaultInit {
+    explicit DefaultInit() = default;
+};
+
+inline constexpr DefaultInit default_init{};
+
+} // namespace cstl
+
+namespace cstl::detail {
+
+// The std::uninitialized_* algorithms and memcpy-based relocation are not
+// usable in constant evaluation; these fall back to std::construct_at loops
+// there. Nothing can throw during constant evaluation, so the loops do not
+// roll back.
+
+template <typename T>
+constexpr void UninitializedValueConstructN(T* first, size_t count) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < count; ++i)
+            std::construct_at(first + i);
+    } else {
+        std::uninitialized_value_construct_n(first, count);
+    }
+}
+
+// Constant evaluation has no indeterminate values: elements are zeroed there
+template <typename T>
+constexpr void UninitializedDefaultConstructN(T* first, size_t count) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < count; ++i)
+            std::construct_at(first + i);
+    } else {
+        std::uninitialized_default_construct_n(first, count);
+    }
+}
+
+template <typename InputIt, typename T>
+constexpr void UninitializedCopyN(InputIt first, size_t count, T* d_first) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < count; ++i, ++first)
+            std::construct_at(d_first + i, *first);
+    } else {
+        std::uninitialized_copy_n(first, count, d_first);
+    }
+}
+
+template <typename InputIt, typename T>
+constexpr T* UninitializedCopy(InputIt first, InputIt last, T* d_first) {
+    if (std::is_constant_evaluated()) {
+        for (; first != last; ++first, ++d_first)
+            std::construct_at(d_first, *first);
+        return d_first;
+    }
+    return std::uninitialized_copy(first, last, d_first);
+}
+
+template <typename T>
+constexpr void UninitializedMoveN(T* first, size_t count, T* d_first) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < count; ++i)
+            std::construct_at(d_first + i, std::move(first[i]));
+    } else {
+        std::uninitialized_move_n(first, count, d_first);
+    }
+}
+
+template <typename T>
+constexpr void UninitializedFillN(T* first, size_t count, const T& value) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < count; ++i)
+            std::construct_at(first + i, value);
+    } else {
+        std::uninitialized_fill_n(first, count, value);
+    }
+}
+
+// Relocates [first, first + count) to d_first in another buffer, for
+// trivially relocatable T: a memcpy at run time, a move-and-destroy loop in
+// constant evaluation
+template <typename T>
+constexpr void Relocate(T* first, size_t count, T* d_first) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < count; ++i) {
+            std::construct_at(d_first + i, std::move(first[i]));
+            std::destroy_at(first + i);
+        }
+    } else if (count) {
+        std::memcpy(
+            static_cast<void*>(d_first),
+            static_cast<const void*>(first),
+            count*sizeof(T)
+        );
+    }
+}
+
+// Like Relocate, within one buffer: the ranges may overlap
+template <typename T>
+constexpr void RelocateWithin(T* first, size_t count, T* d_first) {
+    if (!count || first == d_first)
+        return;
+
+    if (!std::is_constant_evaluated()) {
+        std::memmove(
+            static_cast<void*>(d_first),
+            static_cast<const void*>(first),
+            count*sizeof(T)
+        );
+    } else if (d_first < first) {
+        Relocate(first, count, d_first);
+    } else {
+        for (size_t i = count; i-- > 0;) {
+            std::construct_at(d_first + i, std::move(first[i]));
+            std::destroy_at(first + i);
+        }
+    }
+}
+
+// The overloads below taking an allocator build and destroy elements through
+// std::allocator_traits, so that e.g. a polymorphic_allocator hands its
+// memory_resource on to the elements. Allocators that leave construction to
+// std::construct_at, like std::allocator, keep the algorithms above.
+
+template <typename Allocator, typename T>
+inline constexpr bool constructs_in_place_v
+    = std::is_same_v<Allocator, std::allocator<T>>
+      || (!requires(Allocator& alloc, T* p, T&& value) {
+              alloc.construct(p, std::move(value));
+          }
+          && !requires(Allocator& alloc, T* p) { alloc.destroy(p); });
+
+template <typename Allocator, typename T, typename... Args>
+constexpr T* ConstructAt(Allocator& alloc, T* p, Args&&... args) {
+    if constexpr (constructs_in_place_v<Allocator, T>) {
+        return std::construct_at(p, std::forward<Args>(args)...);
+    } else {
+        std::allocator_traits<Allocator>::construct(alloc, p, std::forward<Args>(args)...);
+        return p;
+    }
+}
+
+template <typename Allocator, typename T>
+constexpr void DestroyAt(Allocator& alloc, T* p) noexcept {
+    if constexpr (constructs_in_place_v<Allocator, T>)
+        std::destroy_at(p);
+    else
+        std::allocator_traits<Allocator>::destroy(alloc, p);
+}
+
+template <typename Allocator, typename T>
+constexpr void DestroyN(Allocator& alloc, T* first, size_t count) noexcept {
+    if constexpr (constructs_in_place_v<Allocator, T>) {
+        std::destroy_n(first, count);
+    } else {
+        for (T* last = first + count; first != last; ++first)
+            std::allocator_traits<Allocator>::destroy(alloc, first);
+    }
+}
+
+template <typename Allocator, typename T>
+constexpr void Destroy(Allocator& alloc, T* first, T* last) noexcept {
+    if constexpr (constructs_in_place_v<Allocator, T>) {
+        std::destroy(first, last);
+    } else {
+        for (; first != last; ++first)
+            std::allocator_traits<Allocator>::destroy(alloc, first);
+    }
+}
+
+// Builds first[i] through make(first + i, i), destroying the elements built
+// so far if one throws
+template <typename Allocator, typename T, typename Make>
+constexpr void ConstructN(Allocator& alloc, T* first, size_t count, Make make) {
+    size_t i = 0;
+    try {
+        for (; i < count; ++i)
+            make(first + i, i);
+    } catch (...) {
+        DestroyN(alloc, first, i);
+        throw;
+    }
+}
+
+template <typename Allocator, typename T>
+constexpr void UninitializedValueConstructN(Allocator& alloc, T* first, size_t count) {
+    if constexpr (constructs_in_place_v<Allocator, T>) {
+        UninitializedValueConstructN(first, count);
+    } else {
+        ConstructN(alloc, first, count, [&alloc](T* p, size_t) {
+            ConstructAt(alloc, p);
+        });
+    }
+}
+
+// Allocators cannot default-initialise: only trivial types, which take no
+// allocator, are left uninitialised, the others are value-initialised
+template <typename Allocator, typename T>
+constexpr void UninitializedDefaultConstructN(Allocator& alloc, T* first, size_t count) {
+    if constexpr (constructs_in_place_v<Allocator, T>
+                  || std::is_trivially_default_constructible_v<T>)
+        UninitializedDefaultConstructN(first, count);
+    else
+        UninitializedValueConstructN(alloc, first, count);
+}
+
+template <typename Allocator, typename InputIt, typename T>
+constexpr void UninitializedCopyN(Allocator& alloc, InputIt first, size_t count, T* d_first) {
+    if constexpr (constructs_in_place_v<Allocator, T>) {
+        UninitializedCopyN(first, count, d_first);
+    } else {
+        ConstructN(alloc, d_first, count, [&alloc, &first](T* p, size_t) {
+            ConstructAt(alloc, p, *first);
+            ++first;
+        });
+    }
+}
+
+template <typename Allocator, typename InputIt, typename T>
+constexpr T* UninitializedCopy(Allocator& alloc, InputIt first, InputIt last, T* d_first) {
+    if constexpr (constructs_in_place_v<Allocator, T>) {
+        return UninitializedCopy(first, last, d_first);
+    } else {
+        T* current = d_first;
+        try {
+            for (; first != last; ++first, ++current)
+                ConstructAt(alloc, current, *first);
+        } catch (...) {
+            DestroyN(alloc, d_first, current - d_first);
+            throw;
+        }
+        return current;
+    }
+}
+
+template <typename Allocator, typename T>
+constexpr void UninitializedMoveN(Allocator& alloc, T* first, size_t count, T* d_first) {
+    if constexpr (constructs_in_place_v<Allocator, T>) {
+        UninitializedMoveN(first, count, d_first);
+    } else {
+        ConstructN(alloc, d_first, count, [&alloc, first](T* p, size_t i) {
+            ConstructAt(alloc, p, std::move(first[i]));
+        });
+    }
+}
+
+template <typename Allocator, typename T>
+constexpr void UninitializedFillN(Allocator& alloc, T* first, size_t count, const T& value) {
+    if constexpr (constructs_in_place_v<Allocator, T>) {
+        UninitializedFillN(first, count, value);
+    } else {
+        ConstructN(alloc, first, count, [&alloc, &value](T* p, size_t) {
+            ConstructAt(alloc, p, value);
+        });
+    }
+}
+
+// Storage for an element built aside, e.g. before it is relocated into a
+// buffer; the holder never destroys it
+template <typename T>
+union Uninitialized {
+    T value;
+
+    constexpr Uninitialized() noexcept {}
+    constexpr ~Uninitialized() {}
+};
+
+} // namespace cstl::detail
@@ -1,143 +1,348 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
+#include <concepts>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
 #include <new>
+#include <type_traits>
 #include <utility>
 
+#include "growth_policy.h"
+#include "instrumentation/capacity_profiler.h"
+#include "instrumentation/instrumentation.h"
+#include "parallel/parallel.h"
+#include "uninitialized.h"
+
 namespace cstl {
 
-// ---------- RawMemory ---------------
+// ---------- Relocation --------------
+
+// A type is trivially relocatable when moving an object to a new address and
+// ending the old object's lifetime is equivalent to copying its bytes. Opt a
+// user type in by specialising this trait:
+//     template <> struct cstl::is_trivially_relocatable<Handle> : std::true_type {};
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T, typename Deleter>
+struct is_trivially_relocatable<std::unique_ptr<T, Deleter>>
+    : is_trivially_relocatable<Deleter> {};
+
+template <typename T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+template <typename T>
+struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type {};
 
 template <typename T>
+inline constexpr bool is_trivially_relocatable_v
+    = is_trivially_relocatable<std::remove_cv_t<T>>::value;
+
+// ---------- RawMemory ---------------
+
+// Result of allocate_at_least(): the block and how many elements fit in it
+template <typename Pointer>
+struct AllocationResult {
+    Pointer ptr;
+    size_t count;
+};
+
+template <typename T, typename Allocator = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                  "Allocator::value_type must be T");
+
+public:
+    using allocator_type = Allocator;
+
 public:
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
+    constexpr explicit RawMemory(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    // The capacity may end up larger than requested if the allocator offers
+    // allocate_at_least
+    constexpr explicit RawMemory(size_t capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , buffer_(Allocate(capacity))
         , capacity_(capacity) {
     }
 
     RawMemory(const RawMemory&) = delete;
 
-    RawMemory(RawMemory&& other) noexcept {
-        Swap(other);
+    constexpr RawMemory(RawMemory&& other) noexcept
+        : alloc_(std::move(other.alloc_))
+        , buffer_(std::exchange(other.buffer_, nullptr))
+        , capacity_(std::exchange(other.capacity_, 0)) {
     }
 
-    ~RawMemory() {
-        Deallocate(buffer_);
+    constexpr ~RawMemory() {
+        Deallocate(buffer_, capacity_);
     }
 
     RawMemory& operator=(const RawMemory&) = delete;
 
-    RawMemory& operator=(RawMemory&& rhs) noexcept {
-        if (this != &rhs)
-            Swap(rhs);
+    // Without propagate_on_container_move_assignment both buffers must come
+    // from equal allocators
+    constexpr RawMemory& operator=(RawMemory&& rhs) noexcept {
+        if (this == &rhs)
+            return *this;
+
+        Deallocate(buffer_, capacity_);
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value)
+            alloc_ = std::move(rhs.alloc_);
+        else
+            assert(alloc_ == rhs.alloc_);
+        buffer_ = std::exchange(rhs.buffer_, nullptr);
+        capacity_ = std::exchange(rhs.capacity_, 0);
 
         return *this;
     }
 
-    T* operator+(size_t offset) noexcept {
+    constexpr T* operator+(size_t offset) noexcept {
         assert(offset <= capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    constexpr const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    constexpr const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    constexpr T& operator[](size_t index) noexcept {
         assert(index < capacity_);
         return buffer_[index];
     }
 
-    const T* GetAddress() const noexcept {
+    constexpr const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    constexpr T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    constexpr size_t Capacity() const {
         return capacity_;
     }
 
-    void Swap(RawMemory& other) noexcept {
+    constexpr const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // For building and destroying elements through AllocTraits, which takes
+    // the allocator by non-const reference
+    constexpr Allocator& GetAllocator() noexcept {
+        return alloc_;
+    }
+
+    // Whether the allocator can resize a buffer itself (see Reallocate)
+    static constexpr bool CanReallocate() noexcept {
+        return requires(Allocator& alloc, T* p, size_t n) {
+            { alloc.reallocate(p, n, n) } -> std::same_as<T*>;
+        };
+    }
+
+    // Resizes the buffer with Allocator::reallocate, which keeps its bytes
+    // but may move them; valid only for trivially relocatable T
+    constexpr void Reallocate(size_t new_capacity) requires (CanReallocate()) {
+        buffer_ = buffer_
+            ? alloc_.reallocate(buffer_, capacity_, new_capacity)
+            : Allocate(new_capacity);
+        capacity_ = new_capacity;
+    }
+
+    // Frees the buffer and uses `alloc` for subsequent allocations
+    constexpr void Reset(const Allocator& alloc) noexcept {
+        Deallocate(buffer_, capacity_);
+        buffer_ = nullptr;
+        capacity_ = 0;
+        alloc_ = alloc;
+    }
+
+    // Allocators are exchanged only if they propagate on swap, otherwise
+    // they must compare equal
+    constexpr void Swap(RawMemory& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
 
 private:
+    [[no_unique_address]] Allocator alloc_{};
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    // Updates n to the number of elements actually allocated
+    constexpr T* Allocate(size_t& n) {
+        if (n == 0)
+            return nullptr;
+
+        if constexpr (requires { alloc_.allocate_at_least(n); }) {
+            auto [buffer, count] = alloc_.allocate_at_least(n);
+            n = count;
+            return buffer;
+        } else {
+            return AllocTraits::allocate(alloc_, n);
+        }
     }
 
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    constexpr void Deallocate(T* buf, size_t n) noexcept {
+        if (buf)
+            AllocTraits::deallocate(alloc_, buf, n);
     }
 };
 
 // ---------- Vector ------------------
 
-template <typename T>
+template <typename T,
+          typename Allocator = std::allocator<T>,
+          typename GrowthPolicy = DoublingGrowth<>>
 class Vector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
 public:
     using iterator = T*;
     using const_iterator = const T*;
+    using allocator_type = Allocator;
+    using growth_policy = GrowthPolicy;
 
 public:
-    Vector() = default;
+    constexpr Vector(CSTL_SITE_PARAM) noexcept(std::is_nothrow_default_constructible_v<Allocator>)
+            : probe_(CSTL_SITE) {
+    }
+
+    constexpr explicit Vector(const Allocator& alloc CSTL_AND_SITE_PARAM) noexcept
+            : data_(alloc)
+            , probe_(CSTL_SITE) {
+    }
+
+    constexpr explicit Vector(const size_t size, const Allocator& alloc = Allocator() CSTL_AND_SITE_PARAM)
+            : data_(size, alloc)
+            , size_(size)
+            , probe_(CSTL_SITE) {
+        parallel::UninitializedValueConstructN(Alloc(), data_.GetAddress(), size);
+        CSTL_INSTRUMENT(OnAllocate, Capacity(), sizeof(T));
+    }
 
-    explicit Vector(const size_t size)
-            : data_(size)
-            , size_(size) {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+    constexpr Vector(const size_t size, DefaultInit, const Allocator& alloc = Allocator()
+           CSTL_AND_SITE_PARAM)
+            : data_(size, alloc)
+            , size_(size)
+            , probe_(CSTL_SITE) {
+        detail::UninitializedDefaultConstructN(Alloc(), data_.GetAddress(), size);
+        CSTL_INSTRUMENT(OnAllocate, Capacity(), sizeof(T));
     }
 
-    Vector(const Vector& other)
-            : data_(other.size_)
-            , size_(other.size_) {
-        std::uninitialized_copy_n(
+    constexpr Vector(const Vector& other CSTL_AND_SITE_PARAM)
+            : Vector(
+                other,
+                AllocTraits::select_on_container_copy_construction(
+                    other.GetAllocator()
+                )
+                CSTL_AND_SITE
+            ) {
+    }
+
+    constexpr Vector(const Vector& other, const Allocator& alloc CSTL_AND_SITE_PARAM)
+            : data_(other.size_, alloc)
+            , size_(other.size_)
+            , growth_(other.growth_)
+            , probe_(CSTL_SITE) {
+        parallel::UninitializedCopyN(
+            Alloc(),
             other.data_.GetAddress(),
             other.size_,
             data_.GetAddress()
         );
+        CSTL_INSTRUMENT(OnAllocate, Capacity(), sizeof(T));
+    }
+
+    constexpr Vector(Vector&& other) noexcept
+            : data_(std::move(other.data_))
+            , size_(std::exchange(other.size_, 0))
+            , growth_(std::move(other.growth_))
+            , probe_(std::move(other.probe_)) {
     }
 
-    Vector(Vector&& other) noexcept {
-        Swap(other);
+    // Steals the buffer of `other` if its allocator equals `alloc`, otherwise
+    // moves the elements one by one into memory obtained from `alloc`
+    constexpr Vector(Vector&& other, const Allocator& alloc)
+            : data_(alloc)
+            , growth_(std::move(other.growth_))
+            , probe_(std::move(other.probe_)) {
+        if (alloc == other.GetAllocator()) {
+            data_.Swap(other.data_);
+            size_ = std::exchange(other.size_, 0);
+        } else {
+            RawMemory<T, Allocator> new_data(other.size_, alloc);
+            detail::UninitializedMoveN(
+                new_data.GetAllocator(),
+                other.data_.GetAddress(),
+                other.size_,
+                new_data.GetAddress()
+            );
+            data_.Swap(new_data);
+            size_ = other.size_;
+            CSTL_INSTRUMENT(OnAllocate, Capacity(), sizeof(T));
+        }
     }
 
-    ~Vector() {
-        std::destroy_n(data_.GetAddress(), size_);
+    constexpr ~Vector() {
+        detail::DestroyN(Alloc(), data_.GetAddress(), size_);
+        CSTL_INSTRUMENT(OnDeallocate, Capacity(), sizeof(T));
+        probe_.OnDestroy(size_);
     }
 
-    Vector& operator=(const Vector& rhs) {
-        if (this != &rhs && rhs.size_ > data_.Capacity()) {
-            Vector tmp(rhs);
+    constexpr Vector& operator=(const Vector& rhs) {
+        if (this == &rhs)
+            return *this;
+
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            if (GetAllocator() != rhs.GetAllocator()) {
+                detail::DestroyN(Alloc(), data_.GetAddress(), size_);
+                size_ = 0;
+                CSTL_INSTRUMENT(OnDeallocate, Capacity(), sizeof(T));
+                data_.Reset(rhs.GetAllocator());
+            }
+        }
+
+        if (rhs.size_ > data_.Capacity()) {
+            Vector tmp(rhs, GetAllocator() CSTL_AND_NO_SITE);
             Swap(tmp);
-        } else if (this != &rhs) {
+        } else {
             for (size_t i = 0; i < size_ && i < rhs.size_; i++)
                 data_[i] = rhs.data_[i];
 
             if (size_ < rhs.size_)
-                std::uninitialized_copy_n(
+                detail::UninitializedCopyN(
+                    Alloc(),
                     rhs.data_ + size_,
                     rhs.size_ - size_,
                     data_.GetAddress() + size_
                 );
             else
-                std::destroy_n(
-                    data_.GetAddress() + rhs.size_, 
+                detail::DestroyN(
+                    Alloc(),
+                    data_.GetAddress() + rhs.size_,
                     size_ - rhs.size_
                 );
             size_ = rhs.size_;
@@ -145,87 +350,212 @@ public:
         return *this;
     }
 
-    Vector& operator=(Vector&& rhs) noexcept {
-        Swap(rhs);
+    constexpr Vector& operator=(Vector&& rhs) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value
+        || AllocTraits::is_always_equal::value
+    ) {
+        if (this == &rhs)
+            return *this;
+
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            detail::DestroyN(Alloc(), data_.GetAddress(), size_);
+            CSTL_INSTRUMENT(OnDeallocate, Capacity(), sizeof(T));
+            data_ = std::move(rhs.data_);
+            size_ = std::exchange(rhs.size_, 0);
+            growth_ = std::move(rhs.growth_);
+        } else if (GetAllocator() == rhs.GetAllocator()) {
+            Swap(rhs);
+        } else {
+            Vector tmp(std::move(rhs), GetAllocator());
+            Swap(tmp);
+        }
         return *this;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    constexpr const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    constexpr T& operator[](size_t index) noexcept {
         assert(index < size_);
         return data_[index];
     }
 
-    iterator begin() noexcept {
+    constexpr iterator begin() noexcept {
         return data_.GetAddress();
     }
 
-    iterator end() noexcept {
+    constexpr iterator end() noexcept {
         return data_.GetAddress() + size_;
     }
 
-    const_iterator begin() const noexcept {
+    constexpr const_iterator begin() const noexcept {
         return data_.GetAddress();
     }
 
-    const_iterator end() const noexcept {
+    constexpr const_iterator end() const noexcept {
         return data_.GetAddress() + size_;
     }
 
-    const_iterator cbegin() const noexcept {
+    constexpr const_iterator cbegin() const noexcept {
         return data_.GetAddress();
     }
 
-    const_iterator cend() const noexcept {
+    constexpr const_iterator cend() const noexcept {
         return data_.GetAddress() + size_;
     }
 
-    void Swap(Vector& other) noexcept {
+    constexpr void Swap(Vector& other) noexcept {
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
+        std::swap(growth_, other.growth_);
+    }
+
+    constexpr const Allocator& GetAllocator() const noexcept {
+        return data_.GetAllocator();
     }
 
-    size_t Size() const noexcept {
+    constexpr size_t Size() const noexcept {
         return size_;
     }
 
-    size_t Capacity() const noexcept {
+    constexpr size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
-    void Reserve(size_t new_capacity) {
+    constexpr void Reserve(size_t new_capacity) {
         if (new_capacity <= Capacity())
             return;
 
-        RawMemory<T> new_data(new_capacity);
+        if constexpr (ReallocatesInPlace()) {
+            CSTL_INSTRUMENT(OnReallocate, Capacity(), new_capacity, 0, sizeof(T));
+            probe_.OnGrowth();
+            data_.Reallocate(new_capacity);
+            return;
+        }
+
+        RawMemory<T, Allocator> new_data(new_capacity, GetAllocator());
         UninitializedCopyOrMoveN(new_data, size_);
+        probe_.OnGrowth();
         DestroyAndSwap(std::move(new_data));
     }
 
-    void Resize(size_t new_size) {
-        Reserve(new_size);
+    // Reallocates to exactly Size() elements, releasing the buffer if empty
+    constexpr void ShrinkToFit() {
+        ShrinkTo(size_);
+    }
 
-        if (size_ < new_size)
-            std::uninitialized_value_construct_n(data_ + size_, new_size - size_);
-        else
-            std::destroy_n(data_ + new_size, size_ - new_size);
+    constexpr void Resize(size_t new_size) {
+        if (size_ < new_size) {
+            Reserve(new_size);
+            parallel::UninitializedValueConstructN(Alloc(), data_ + size_, new_size - size_);
+        } else {
+            detail::DestroyN(Alloc(), data_ + new_size, size_ - new_size);
+        }
         size_ = new_size;
+        MaybeReclaim();
+    }
+
+    // Like Resize, but new elements are default-initialised, so trivial
+    // types are not zeroed
+    constexpr void ResizeDefaultInit(size_t new_size) {
+        if (size_ < new_size) {
+            Reserve(new_size);
+            detail::UninitializedDefaultConstructN(Alloc(), data_ + size_, new_size - size_);
+        } else {
+            detail::DestroyN(Alloc(), data_ + new_size, size_ - new_size);
+        }
+        size_ = new_size;
+        MaybeReclaim();
+    }
+
+    // Grows without touching the new elements' memory at all; restricted to
+    // types for which that is the same as default-initialisation
+    constexpr void ResizeUninitialized(size_t new_size)
+    requires (std::is_trivially_default_constructible_v<T>
+              && std::is_trivially_destructible_v<T>) {
+        ResizeDefaultInit(new_size);
+    }
+
+    // Grows to `new_size` and lets `fill(tail, n)` write the n new elements
+    // in place (default-initialised, i.e. raw for trivial types). `fill`
+    // returns how many of them it produced; the rest are dropped.
+    template <typename Fill>
+    constexpr void ResizeAndOverwrite(size_t new_size, Fill fill) {
+        assert(new_size >= size_);
+
+        const size_t old_size = size_;
+        ResizeDefaultInit(new_size);
+
+        const size_t produced = fill(data_ + old_size, new_size - old_size);
+        assert(produced <= new_size - old_size);
+        ResizeDefaultInit(old_size + produced);
+    }
+
+    constexpr void Clear() noexcept {
+        detail::DestroyN(Alloc(), data_.GetAddress(), size_);
+        size_ = 0;
+        MaybeReclaim();
     }
 
-    void PopBack() {
+    // Replaces the contents, reallocating only if they do not fit
+    template <std::input_iterator InputIt>
+    constexpr void Assign(InputIt first, InputIt last) {
+        if constexpr (!IsForwardIterator<InputIt>()) {
+            Clear();
+            for (; first != last; ++first)
+                EmplaceBack(*first);
+        } else {
+            const size_t count = std::distance(first, last);
+            if (count > Capacity()) {
+                RawMemory<T, Allocator> new_data(count, GetAllocator());
+                detail::UninitializedCopyN(new_data.GetAllocator(), first, count, new_data.GetAddress());
+                detail::DestroyN(Alloc(), data_.GetAddress(), size_);
+                CSTL_INSTRUMENT(OnReallocate, Capacity(), new_data.Capacity(), 0, sizeof(T));
+                probe_.OnGrowth();
+                data_.Swap(new_data);
+            } else if (count > size_) {
+                InputIt mid = std::next(first, size_);
+                std::copy(first, mid, begin());
+                detail::UninitializedCopy(Alloc(), mid, last, end());
+            } else {
+                std::copy(first, last, begin());
+                detail::DestroyN(Alloc(), data_ + count, size_ - count);
+            }
+            size_ = count;
+        }
+    }
+
+    template <typename Range>
+    constexpr void Assign(Range&& range) {
+        Assign(std::begin(range), std::end(range));
+    }
+
+    template <typename Range>
+    constexpr void Append(Range&& range) {
+        Insert(end(), std::begin(range), std::end(range));
+    }
+
+    constexpr void PopBack() {
         assert(size_);
 
-        std::destroy_at(data_ + size_ - 1);
+        detail::DestroyAt(Alloc(), data_ + size_ - 1);
         --size_;
+        MaybeReclaim();
     }
 
-    iterator Erase(const_iterator pos) {
+    constexpr iterator Erase(const_iterator pos) {
         assert(pos >= begin() && pos < end());
 
         size_t index = pos - begin();
+        if constexpr (is_trivially_relocatable_v<T>) {
+            detail::DestroyAt(Alloc(), data_ + index);
+            RelocateTail(index + 1, index);
+            --size_;
+            MaybeReclaim();
+            return std::next(begin(), index);
+        }
+
         if (index + 1 < size_)
             std::move(
                 data_.GetAddress() + index + 1,
@@ -237,85 +567,202 @@ public:
         return std::next(begin(), index);
     }
 
-    void PushBack(const T& value) {
-        if (size_ == Capacity()) {
-            RawMemory<T> new_data(size_ == 0 ? 1 : 2*size_);
-            new (new_data + size_) T(value);
-            UninitializedCopyOrMoveN(new_data, size_);
-            DestroyAndSwap(std::move(new_data));
+    constexpr iterator Erase(const_iterator first, const_iterator last) {
+        assert(first >= begin() && first <= last && last <= end());
+
+        const size_t index = first - begin();
+        const size_t count = last - first;
+        if (count == 0)
+            return std::next(begin(), index);
+
+        if constexpr (is_trivially_relocatable_v<T>) {
+            detail::DestroyN(Alloc(), data_ + index, count);
+            RelocateTail(index + count, index);
         } else {
-            new (data_ + size_) T(value);
+            std::move(data_ + index + count, data_ + size_, data_ + index);
+            detail::DestroyN(Alloc(), data_ + size_ - count, count);
         }
-        ++size_;
+        size_ -= count;
+        MaybeReclaim();
+
+        return std::next(begin(), index);
     }
 
-    void PushBack(T&& value) {
-        if (size_ == Capacity()) {
-            RawMemory<T> new_data(size_ == 0 ? 1 : 2*size_);
-            new (new_data + size_) T(std::move(value));
-            UninitializedCopyOrMoveN(new_data, size_);
-            DestroyAndSwap(std::move(new_data));
+    // Removes the elements matching `pred` in a single stable pass and
+    // returns how many were removed
+    template <typename Predicate>
+    constexpr size_t EraseIf(Predicate pred) {
+        if constexpr (!is_trivially_relocatable_v<T>) {
+            const size_t old_size = size_;
+            Erase(std::remove_if(begin(), end(), std::ref(pred)), end());
+            return old_size - size_;
         } else {
-            new (data_ + size_) T(std::move(value));
+            // Survivors are relocated over the holes left by removed elements
+            size_t kept = 0;
+            size_t i = 0;
+            try {
+                for (; i < size_; ++i) {
+                    if (pred(data_[i]))
+                        detail::DestroyAt(Alloc(), data_ + i);
+                    else if (kept++ != i)
+                        detail::RelocateWithin(data_ + i, 1, data_ + kept - 1);
+                }
+            } catch (...) {
+                RelocateTail(i, kept);
+                size_ = kept + (size_ - i);
+                throw;
+            }
+
+            const size_t removed = size_ - kept;
+            size_ = kept;
+            MaybeReclaim();
+            return removed;
         }
-        ++size_;
     }
 
-    inline iterator Insert(const_iterator pos, const T& value) noexcept {
+    // Removes the element at `pos` in O(1) by moving the last element into
+    // its place; the order of elements is not preserved
+    constexpr iterator SwapErase(const_iterator pos) {
+        assert(pos >= begin() && pos < end());
+
+        const size_t index = pos - begin();
+        if constexpr (is_trivially_relocatable_v<T>) {
+            detail::DestroyAt(Alloc(), data_ + index);
+            if (index + 1 != size_)
+                detail::RelocateWithin(data_ + size_ - 1, 1, data_ + index);
+            --size_;
+            MaybeReclaim();
+        } else {
+            if (index + 1 != size_)
+                data_[index] = std::move(data_[size_ - 1]);
+            PopBack();
+        }
+
+        return std::next(begin(), index);
+    }
+
+    constexpr void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    constexpr void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    constexpr iterator Insert(const_iterator pos, const T& value) {
         return Emplace(pos, value);
     }
 
-    inline iterator Insert(const_iterator pos, T&& value) noexcept {
+    constexpr iterator Insert(const_iterator pos, T&& value) {
         return Emplace(pos, std::forward<T>(value));
     }
 
+    constexpr iterator Insert(const_iterator pos, size_t count, const T& value) {
+        assert(pos >= begin() && pos <= end());
+
+        // value may refer to an element that is about to move
+        const T tmp = std::make_obj_using_allocator<T>(GetAllocator(), value);
+        return InsertN(
+            pos - begin(),
+            count,
+            [this, &tmp](T* d_first, size_t, size_t n) {
+                detail::UninitializedFillN(Alloc(), d_first, n, tmp);
+            },
+            [&tmp](T* d_first, size_t, size_t n) {
+                std::fill_n(d_first, n, tmp);
+            }
+        );
+    }
+
+    // Inserts [first, last), which must not point into *this, reallocating at
+    // most once and shifting the tail once. Single-pass input is gathered
+    // into a temporary vector first.
+    template <std::input_iterator InputIt>
+    constexpr iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        assert(pos >= begin() && pos <= end());
+
+        if constexpr (!IsForwardIterator<InputIt>()) {
+            const size_t index = pos - begin();
+            Vector tmp(GetAllocator() CSTL_AND_NO_SITE);
+            for (; first != last; ++first)
+                tmp.EmplaceBack(*first);
+            return Insert(
+                begin() + index,
+                std::make_move_iterator(tmp.begin()),
+                std::make_move_iterator(tmp.end())
+            );
+        } else {
+            return InsertN(
+                pos - begin(),
+                std::distance(first, last),
+                [this, first](T* d_first, size_t offset, size_t n) {
+                    detail::UninitializedCopyN(Alloc(), std::next(first, offset), n, d_first);
+                },
+                [first](T* d_first, size_t offset, size_t n) {
+                    std::copy_n(std::next(first, offset), n, d_first);
+                }
+            );
+        }
+    }
+
     template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
+    constexpr T& EmplaceBack(Args&&... args) {
+        if constexpr (ReallocatesInPlace()) {
+            if (size_ == Capacity()) {
+                EmplaceWithReallocate(size_, std::forward<Args>(args)...);
+                return data_[size_++];
+            }
+        }
+
         if (size_ == Capacity()) {
-            RawMemory<T> new_data(size_ == 0 ? 1 : 2*size_);
-            new (new_data + size_) T(std::forward<Args>(args)...);
+            RawMemory<T, Allocator> new_data(NextCapacity(), GetAllocator());
+            detail::ConstructAt(Alloc(), new_data + size_, std::forward<Args>(args)...);
             UninitializedCopyOrMoveN(new_data, size_);
+            probe_.OnGrowth();
             DestroyAndSwap(std::move(new_data));
         } else {
-            new (data_ + size_) T(std::forward<Args>(args)...);
+            detail::ConstructAt(Alloc(), data_ + size_, std::forward<Args>(args)...);
         }
         return data_[size_++];
     }
 
     template <typename... Args>
-    iterator Emplace(const_iterator pos, Args&&... args) {
+    constexpr iterator Emplace(const_iterator pos, Args&&... args) {
         assert(pos >= begin() && pos <= end());
 
         if (pos == end()) {
-            EmplaceBack(std::move(args)...);
+            EmplaceBack(std::forward<Args>(args)...);
             return std::prev(end());
         }
 
         size_t index = pos - begin();
+        if constexpr (ReallocatesInPlace()) {
+            if (size_ == Capacity()) {
+                EmplaceWithReallocate(index, std::forward<Args>(args)...);
+                ++size_;
+                return std::next(begin(), index);
+            }
+        }
+
         if (size_ == Capacity()) {
-            RawMemory<T> new_data(size_ == 0 ? 1 : 2*size_);
-            new (new_data + index) T(std::forward<Args>(args)...);
+            RawMemory<T, Allocator> new_data(NextCapacity(), GetAllocator());
+            detail::ConstructAt(Alloc(), new_data + index, std::forward<Args>(args)...);
 
             UninitializedCopyOrMoveN(new_data, index);
-            if constexpr (std::is_nothrow_move_constructible_v<T>
-                          || !std::is_copy_constructible_v<T>)
-                std::uninitialized_move_n(
-                    data_.GetAddress() + index,
-                    size_ - index,
-                    new_data.GetAddress() + index + 1
-                );
-            else
-                std::uninitialized_copy_n(
-                    data_.GetAddress() + index,
-                    size_ - index,
-                    new_data.GetAddress() + index + 1
-                );
-
+            UninitializedCopyOrMoveN(new_data, size_ - index, index, index + 1);
+            probe_.OnGrowth();
             DestroyAndSwap(std::move(new_data));
+        } else if constexpr (is_trivially_relocatable_v<T>) {
+            // Build the element aside first: args may refer into the tail
+            detail::Uninitialized<T> tmp;
+            detail::ConstructAt(Alloc(), &tmp.value, std::forward<Args>(args)...);
+
+            RelocateTail(index, index + 1);
+            detail::Relocate(&tmp.value, 1, data_ + index);
         } else {
-            T tmp = T(std::forward<Args>(args)...);
+            T tmp = std::make_obj_using_allocator<T>(GetAllocator(), std::forward<Args>(args)...);
 
-            new (data_ + size_) T(std::move(data_[size_ - 1u]));
+            detail::ConstructAt(Alloc(), data_ + size_, std::move(data_[size_ - 1u]));
             std::move_backward(
                 data_.GetAddress() + index,
                 std::prev(end()),
@@ -329,29 +776,220 @@ public:
     }
 
 private:
-    RawMemory<T> data_;
+    RawMemory<T, Allocator> data_;
     size_t size_ = 0;
+    [[no_unique_address]] GrowthPolicy growth_{};
+    [[no_unique_address]] profiling::CapacityProbe probe_;
+
+    constexpr Allocator& Alloc() noexcept {
+        return data_.GetAllocator();
+    }
+
+    constexpr size_t NextCapacity() {
+        return growth_.NextCapacity(Capacity(), size_ + 1, sizeof(T));
+    }
+
+    template <typename It>
+    static constexpr bool IsForwardIterator() noexcept {
+        return std::is_base_of_v<
+            std::forward_iterator_tag,
+            typename std::iterator_traits<It>::iterator_category
+        >;
+    }
+
+    // Opens a gap of `count` elements at `index` and fills it through
+    // `construct(d_first, offset, n)`, which builds source elements
+    // [offset, offset + n) in raw memory, and `assign(d_first, offset, n)`,
+    // which assigns them over live elements.
+    template <typename Construct, typename Assign>
+    constexpr iterator InsertN(size_t index, size_t count, Construct construct, Assign assign) {
+        if (count == 0)
+            return std::next(begin(), index);
+
+        if (size_ + count > Capacity()) {
+            const size_t new_capacity
+                = growth_.NextCapacity(Capacity(), size_ + count, sizeof(T));
+
+            if constexpr (ReallocatesInPlace()) {
+                CSTL_INSTRUMENT(OnReallocate, Capacity(), new_capacity, 0, sizeof(T));
+                probe_.OnGrowth();
+                data_.Reallocate(new_capacity);
+            } else {
+                RawMemory<T, Allocator> new_data(new_capacity, GetAllocator());
+                construct(new_data + index, 0, count);
+
+                UninitializedCopyOrMoveN(new_data, index);
+                UninitializedCopyOrMoveN(new_data, size_ - index, index, index + count);
+                probe_.OnGrowth();
+                DestroyAndSwap(std::move(new_data));
+                size_ += count;
+                return std::next(begin(), index);
+            }
+        }
 
-    void UninitializedCopyOrMoveN(RawMemory<T>& new_data, size_t index) {
-        if constexpr (std::is_nothrow_move_constructible_v<T>
-                      || !std::is_copy_constructible_v<T>)
-            std::uninitialized_move_n(
-                data_.GetAddress(),
-                index,
-                new_data.GetAddress()
+        if constexpr (is_trivially_relocatable_v<T>) {
+            RelocateTail(index, index + count);
+            try {
+                construct(data_ + index, 0, count);
+            } catch (...) {
+                detail::RelocateWithin(data_ + index + count, size_ - index, data_ + index);
+                throw;
+            }
+            size_ += count;
+        } else {
+            const size_t old_size = size_;
+            const size_t elems_after = old_size - index;
+
+            if (elems_after > count) {
+                detail::UninitializedMoveN(
+                    Alloc(),
+                    data_ + old_size - count,
+                    count,
+                    data_ + old_size
+                );
+                size_ += count;
+                std::move_backward(
+                    data_ + index,
+                    data_ + old_size - count,
+                    data_ + old_size
+                );
+                assign(data_ + index, 0, count);
+            } else {
+                construct(data_ + old_size, elems_after, count - elems_after);
+                size_ += count - elems_after;
+                detail::UninitializedMoveN(
+                    Alloc(),
+                    data_ + index,
+                    elems_after,
+                    data_ + index + count
+                );
+                size_ += elems_after;
+                assign(data_ + index, 0, elems_after);
+            }
+        }
+        return std::next(begin(), index);
+    }
+
+    // Moves the elements into a buffer of `new_capacity` (at least size_)
+    constexpr void ShrinkTo(size_t new_capacity) {
+        assert(new_capacity >= size_);
+        if (new_capacity >= Capacity())
+            return;
+
+        if (new_capacity == 0) {
+            CSTL_INSTRUMENT(OnDeallocate, Capacity(), sizeof(T));
+            RawMemory<T, Allocator> empty(GetAllocator());
+            data_.Swap(empty);
+            return;
+        }
+
+        if constexpr (ReallocatesInPlace()) {
+            CSTL_INSTRUMENT(OnReallocate, Capacity(), new_capacity, 0, sizeof(T));
+            data_.Reallocate(new_capacity);
+            return;
+        }
+
+        RawMemory<T, Allocator> new_data(new_capacity, GetAllocator());
+        UninitializedCopyOrMoveN(new_data, size_);
+        DestroyAndSwap(std::move(new_data));
+    }
+
+    // Gives memory back after removals if the growth policy asks for it
+    // through ShrinkCapacity(). Shrinking keeps the old buffer if it throws.
+    constexpr void MaybeReclaim() noexcept {
+        if constexpr (requires { growth_.ShrinkCapacity(Capacity(), size_, sizeof(T)); }) {
+            const size_t new_capacity = growth_.ShrinkCapacity(Capacity(), size_, sizeof(T));
+            if (new_capacity < Capacity()) {
+                try {
+                    ShrinkTo(std::max(new_capacity, size_));
+                } catch (...) {
+                }
+            }
+        }
+    }
+
+    // Growth through Allocator::reallocate (e.g. mremap) instead of
+    // allocate-relocate-free
+    static constexpr bool ReallocatesInPlace() noexcept {
+        return is_trivially_relocatable_v<T>
+               && RawMemory<T, Allocator>::CanReallocate();
+    }
+
+    // The element is built aside before the buffer moves: args may refer to
+    // elements of *this
+    template <typename... Args>
+    constexpr void EmplaceWithReallocate(size_t index, Args&&... args) {
+        detail::Uninitialized<T> tmp;
+        T* element = detail::ConstructAt(Alloc(), &tmp.value, std::forward<Args>(args)...);
+
+        try {
+            if constexpr (ReallocatesInPlace()) {
+                // Once: a stateful growth policy may answer differently
+                const size_t new_capacity = NextCapacity();
+                CSTL_INSTRUMENT(OnReallocate, Capacity(), new_capacity, 0, sizeof(T));
+                probe_.OnGrowth();
+                data_.Reallocate(new_capacity);
+            }
+        } catch (...) {
+            detail::DestroyAt(Alloc(), element);
+            throw;
+        }
+
+        RelocateTail(index, index + 1);
+        detail::Relocate(element, 1, data_ + index);
+    }
+
+    // Moves (or copies, if moving may throw) `count` elements starting at
+    // `first` into `new_data` at `d_first`. Trivially relocatable elements are
+    // copied bytewise and must not be destroyed afterwards, see DestroyAndSwap.
+    constexpr void UninitializedCopyOrMoveN(RawMemory<T, Allocator>& new_data, size_t count,
+                                            size_t first = 0, size_t d_first = 0) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            detail::Relocate(data_ + first, count, new_data + d_first);
+        } else if constexpr (std::is_nothrow_move_constructible_v<T>
+                             || !std::is_copy_constructible_v<T>) {
+            detail::UninitializedMoveN(
+                new_data.GetAllocator(),
+                data_ + first,
+                count,
+                new_data + d_first
             );
-        else
-            std::uninitialized_copy_n(
-                data_.GetAddress(),
-                index,
-                new_data.GetAddress()
+        } else {
+            detail::UninitializedCopyN(
+                new_data.GetAllocator(),
+                data_ + first,
+                count,
+                new_data + d_first
             );
+        }
     }
 
-    inline void DestroyAndSwap(RawMemory<T>&& new_data) {
-        std::destroy_n(data_.GetAddress(), size_);
+    constexpr void DestroyAndSwap(RawMemory<T, Allocator>&& new_data) {
+        if constexpr (!is_trivially_relocatable_v<T>)
+            detail::DestroyN(Alloc(), data_.GetAddress(), size_);
+        CSTL_INSTRUMENT(OnReallocate, Capacity(), new_data.Capacity(), size_, sizeof(T));
         data_.Swap(new_data);
     }
+
+    // Moves [index, size_) to start at d_index as raw bytes
+    constexpr void RelocateTail(size_t index, size_t d_index) {
+        if (index < size_)
+            detail::RelocateWithin(data_ + index, size_ - index, data_ + d_index);
+    }
 };
 
+template <typename T, typename Allocator, typename GrowthPolicy, typename Predicate>
+constexpr size_t EraseIf(Vector<T, Allocator, GrowthPolicy>& vector, Predicate pred) {
+    return vector.EraseIf(pred);
+}
+
+namespace pmr {
+
+// Vector whose storage comes from a std::pmr::memory_resource, which is also
+// passed on to allocator-aware elements such as std::pmr::string
+template <typename T, typename GrowthPolicy = DoublingGrowth<>>
+using Vector = cstl::Vector<T, std::pmr::polymorphic_allocator<T>, GrowthPolicy>;
+
+} // namespace pmr
+
 } // namespace cstl
\ No newline at end of file
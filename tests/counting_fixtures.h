@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+
+// Element type counting its live instances, moves and copies; copying the
+// one whose id is throw_on_copy_id throws
+struct Obj {
+    Obj() {
+        ++num_alive;
+    }
+
+    explicit Obj(int id) : id(id) {
+        ++num_alive;
+    }
+
+    Obj(const Obj& other) : id(other.id) {
+        if (other.id == throw_on_copy_id)
+            throw std::runtime_error("copy");
+        ++num_alive;
+        ++num_copied;
+    }
+
+    Obj(Obj&& other) noexcept : id(other.id) {
+        ++num_alive;
+        ++num_moved;
+    }
+
+    Obj& operator=(const Obj& other) = default;
+
+    Obj& operator=(Obj&& other) noexcept = default;
+
+    ~Obj() {
+        --num_alive;
+    }
+
+    static int GetAliveObjectCount() {
+        return num_alive;
+    }
+
+    static void ResetCounters() {
+        num_alive = 0;
+        num_copied = 0;
+        num_moved = 0;
+        throw_on_copy_id = NO_ID;
+    }
+
+    int id = 0;
+
+    static inline int num_alive = 0;
+    static inline int num_copied = 0;
+    static inline int num_moved = 0;
+    // No object has this id, so no copy throws
+    static constexpr int NO_ID = std::numeric_limits<int>::min();
+    static inline int throw_on_copy_id = NO_ID;
+};
+
+// Memory resource counting the allocations that reach it and the bytes in use
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t bytes_in_use = 0;
+    size_t num_allocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        bytes_in_use += bytes;
+        ++num_allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        bytes_in_use -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
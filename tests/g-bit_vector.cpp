@@ -0,0 +1,186 @@
+#include "bit_vector/bit_vector.h"
+#include "bit_vector/rank_select.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+std::vector<bool> RandomBits(size_t size, double density, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::bernoulli_distribution bit(density);
+    std::vector<bool> bits(size);
+    for (size_t i = 0; i < size; ++i)
+        bits[i] = bit(rng);
+    return bits;
+}
+
+template <typename Bits>
+cstl::BitVector<> ToBitVector(const Bits& bits) {
+    cstl::BitVector<> result;
+    for (const bool bit : bits)
+        result.PushBack(bit);
+    return result;
+}
+
+} // namespace
+
+TEST(BitVector, PushBackAndResize) {
+    using namespace cstl;
+    const std::vector<bool> expected = RandomBits(1000, 0.3, 1);
+    BitVector<> v = ToBitVector(expected);
+    ASSERT_EQ(v.Size(), 1000);
+    ASSERT_EQ(v.Words().size(), 16);
+    ASSERT_TRUE(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+    v.Resize(70);
+    v.Resize(200, true);
+    for (size_t i = 0; i < 200; ++i)
+        ASSERT_EQ(v[i], i < 70 ? static_cast<bool>(expected[i]) : true);
+    v.Resize(65);
+    v.Resize(128);
+    ASSERT_EQ(v.Count(), std::count(expected.begin(), expected.begin() + 65, true));
+
+    v.PopBack();
+    ASSERT_EQ(v.Size(), 127);
+
+    BitVector<> ones(130, true);
+    ASSERT_EQ(ones.Count(), 130);
+    ASSERT_EQ(ones.Words()[2], 0b11);
+}
+
+TEST(BitVector, ProxyReferences) {
+    using namespace cstl;
+    BitVector<> v(100);
+    v[3] = true;
+    v[64] = v[3];
+    v[99].Flip();
+    ASSERT_EQ(v.Count(), 3);
+
+    for (auto bit : v)
+        bit = !bit;
+    ASSERT_EQ(v.Count(), 97);
+    ASSERT_FALSE(v[64]);
+
+    std::fill(v.begin() + 10, v.end(), false);
+    ASSERT_EQ(v.Count(), 9);
+
+    const BitVector<>& cv = v;
+    ASSERT_EQ(std::count(cv.begin(), cv.end(), true), 9);
+    BitVector<>::const_iterator it = v.begin();
+    ASSERT_TRUE(*it);
+}
+
+TEST(BitVector, FindAndCount) {
+    using namespace cstl;
+    const std::vector<bool> expected = RandomBits(5000, 0.01, 2);
+    const BitVector<> v = ToBitVector(expected);
+
+    std::vector<size_t> positions;
+    for (size_t i = v.FindFirst(); i != v.Size(); i = v.FindNext(i))
+        positions.push_back(i);
+
+    std::vector<size_t> expected_positions;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (expected[i])
+            expected_positions.push_back(i);
+    }
+    ASSERT_EQ(positions, expected_positions);
+    ASSERT_EQ(v.Count(), expected_positions.size());
+
+    ASSERT_EQ(BitVector<>(300).FindFirst(), 300);
+    ASSERT_EQ(BitVector<>().FindFirst(), 0);
+}
+
+TEST(BitVector, BulkOperations) {
+    using namespace cstl;
+    const std::vector<bool> a = RandomBits(777, 0.5, 3);
+    const std::vector<bool> b = RandomBits(777, 0.5, 4);
+    const BitVector<> va = ToBitVector(a);
+    const BitVector<> vb = ToBitVector(b);
+
+    const BitVector<> and_ = va & vb;
+    const BitVector<> or_ = va | vb;
+    const BitVector<> xor_ = va ^ vb;
+    BitVector<> and_not = va;
+    and_not.AndNot(vb);
+    BitVector<> flipped = va;
+    flipped.FlipAll();
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        ASSERT_EQ(and_[i], a[i] && b[i]);
+        ASSERT_EQ(or_[i], a[i] || b[i]);
+        ASSERT_EQ(xor_[i], a[i] != b[i]);
+        ASSERT_EQ(and_not[i], a[i] && !b[i]);
+        ASSERT_EQ(flipped[i], !a[i]);
+    }
+    ASSERT_EQ(flipped.Count(), 777 - va.Count());
+    ASSERT_TRUE((va ^ va) == BitVector<>(777));
+
+    BitVector<> all(777);
+    all.SetAll();
+    ASSERT_TRUE((flipped | va) == all);
+}
+
+TEST(BitVector, AssignmentKeepsAllocator) {
+    using namespace cstl;
+    using PmrBitVector = BitVector<std::pmr::polymorphic_allocator<uint64_t>>;
+    std::pmr::monotonic_buffer_resource lhs_arena;
+    std::pmr::monotonic_buffer_resource rhs_arena;
+
+    PmrBitVector lhs(3, true, &lhs_arena);
+    PmrBitVector rhs(200, false, &rhs_arena);
+    rhs[150] = true;
+
+    // Allocators that do not propagate stay put; the bits are copied over
+    lhs = rhs;
+    ASSERT_EQ(lhs.GetAllocator().resource(), &lhs_arena);
+    ASSERT_TRUE(lhs == rhs);
+
+    lhs = PmrBitVector(70, true, &rhs_arena);
+    ASSERT_EQ(lhs.GetAllocator().resource(), &lhs_arena);
+    ASSERT_EQ(lhs.Size(), 70);
+    ASSERT_EQ(lhs.Count(), 70);
+
+    PmrBitVector same(5, true, &lhs_arena);
+    lhs = std::move(same);
+    ASSERT_EQ(lhs.Size(), 5);
+    ASSERT_EQ(lhs.Count(), 5);
+    static_assert(!std::is_nothrow_move_assignable_v<PmrBitVector>);
+    static_assert(std::is_nothrow_move_assignable_v<BitVector<>>);
+}
+
+TEST(BitVector, RankSelect) {
+    using namespace cstl;
+    {
+        const RankSelect index;
+        ASSERT_EQ(index.Size(), 0);
+        ASSERT_EQ(index.Count(), 0);
+        ASSERT_EQ(index.Rank(0), 0);
+        ASSERT_EQ(index.Select(0), 0);
+    }
+    for (const size_t size : {0, 1, 64, 511, 512, 513, 4096, 70001}) {
+        for (const double density : {0.0, 0.001, 0.1, 0.5, 1.0}) {
+            const std::vector<bool> expected = RandomBits(size, density, size);
+            const BitVector<> v = ToBitVector(expected);
+            const RankSelect index(v);
+            ASSERT_EQ(index.Count(), v.Count());
+
+            size_t rank = 0;
+            for (size_t i = 0; i < size; ++i) {
+                ASSERT_EQ(index.Rank(i), rank);
+                if (expected[i]) {
+                    ASSERT_EQ(index.Select(rank), i);
+                    ++rank;
+                }
+            }
+            ASSERT_EQ(index.Rank(size), rank);
+            ASSERT_EQ(index.Select(rank), size);
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#define CSTL_CAPACITY_PROFILING
+#include "instrumentation/capacity_profiler.h"
+#include "simple_vector/simple_vector.h"
+#include "vector/vector.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// Stats of the only site whose key contains `function`
+cstl::profiling::SiteStats StatsOf(const std::string& function) {
+    cstl::profiling::SiteStats found;
+    int matches = 0;
+    for (const auto& [site, stats] : cstl::profiling::Profiler::Instance().Snapshot())
+        if (site.find(function) != std::string::npos) {
+            found = stats;
+            ++matches;
+        }
+    EXPECT_EQ(matches, 1);
+    return found;
+}
+
+void BuildVector(size_t size) {
+    cstl::Vector<int> v;
+    for (size_t i = 0; i < size; ++i)
+        v.PushBack(static_cast<int>(i));
+}
+
+void DrainVector(size_t size) {
+    cstl::Vector<std::string, std::allocator<std::string>, cstl::ReclaimingGrowth<>> v;
+    for (size_t i = 0; i < size; ++i)
+        v.PushBack(std::to_string(i));
+    while (v.Size() > 1)
+        v.PopBack();
+    v.ShrinkToFit();
+}
+
+void BuildSimpleVector(size_t size) {
+    cstl::SimpleVector<int> v;
+    for (size_t i = 0; i < size; ++i)
+        v.PushBack(static_cast<int>(i));
+}
+
+} // namespace
+
+TEST(CapacityProfiler, Vector) {
+    using namespace cstl;
+    profiling::Profiler::Instance().Reset();
+
+    for (int i = 0; i < 9; ++i)
+        BuildVector(100);
+    BuildVector(1000);
+
+    const profiling::SiteStats stats = StatsOf("BuildVector");
+    ASSERT_EQ(stats.instances, 10);
+    ASSERT_EQ(stats.max_size, 1000);
+    // 1 -> 128 and 1 -> 1024 by doubling
+    ASSERT_EQ(stats.growth_steps, 9*8 + 11);
+    ASSERT_EQ(stats.histogram[7], 9);
+    ASSERT_EQ(stats.histogram[10], 1);
+    ASSERT_EQ(stats.SuggestedReserve(), 127);
+}
+
+TEST(CapacityProfiler, ShrinkingIsNotGrowth) {
+    using namespace cstl;
+    profiling::Profiler::Instance().Reset();
+
+    DrainVector(1000);
+
+    // Reclaiming after removals and ShrinkToFit do not count as steps
+    const profiling::SiteStats stats = StatsOf("DrainVector");
+    ASSERT_EQ(stats.instances, 1);
+    ASSERT_EQ(stats.growth_steps, 11);
+}
+
+TEST(CapacityProfiler, CopiesAndMoves) {
+    using namespace cstl;
+    profiling::Profiler::Instance().Reset();
+
+    {
+        Vector<int> v(10);
+        Vector<int> copy(v);
+        Vector<int> moved(std::move(v));
+        copy = moved;
+    }
+
+    // The moved-from vector reports nothing, its contents report once
+    const auto sites = profiling::Profiler::Instance().Snapshot();
+    ASSERT_EQ(sites.size(), 2);
+    for (const auto& [site, stats] : sites) {
+        ASSERT_EQ(stats.instances, 1);
+        ASSERT_EQ(stats.max_size, 10);
+    }
+}
+
+TEST(CapacityProfiler, SimpleVector) {
+    using namespace cstl;
+    profiling::Profiler::Instance().Reset();
+
+    BuildSimpleVector(0);
+    BuildSimpleVector(5);
+
+    const profiling::SiteStats stats = StatsOf("BuildSimpleVector");
+    ASSERT_EQ(stats.instances, 2);
+    ASSERT_EQ(stats.histogram[0], 1);
+    ASSERT_EQ(stats.histogram[3], 1);
+    ASSERT_EQ(stats.SuggestedReserve(), 5);
+    // Capacity 1, 2, 4 and 8
+    ASSERT_EQ(stats.growth_steps, 4);
+}
+
+TEST(CapacityProfiler, ConstantEvaluation) {
+    using namespace cstl;
+
+    // Probes of vectors built at compile time record nothing
+    static_assert([] {
+        Vector<int> v;
+        for (int i = 0; i < 10; ++i)
+            v.PushBack(i);
+        return v[9];
+    }() == 9);
+}
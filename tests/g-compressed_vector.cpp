@@ -0,0 +1,134 @@
+#include "compressed_vector/compressed_vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+template <typename Int>
+cstl::CompressedVector<Int> Compress(const std::vector<Int>& values) {
+    cstl::CompressedVector<Int> result;
+    for (const Int value : values)
+        result.PushBack(value);
+    return result;
+}
+
+template <typename Int>
+void ExpectRoundTrip(const std::vector<Int>& values) {
+    const cstl::CompressedVector<Int> v = Compress(values);
+    ASSERT_EQ(v.Size(), values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+        ASSERT_EQ(v[i], values[i]);
+    ASSERT_TRUE(std::equal(v.begin(), v.end(), values.begin(), values.end()));
+
+    std::vector<Int> scanned;
+    v.ForEachBlock([&](std::span<const Int> block) {
+        scanned.insert(scanned.end(), block.begin(), block.end());
+    });
+    ASSERT_EQ(scanned, values);
+}
+
+} // namespace
+
+TEST(CompressedVector, SortedIds) {
+    using namespace cstl;
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> ids(100000);
+    uint64_t id = uint64_t{1} << 40;
+    for (uint64_t& value : ids) {
+        id += 1 + rng() % 200;
+        value = id;
+    }
+    ExpectRoundTrip(ids);
+
+    const CompressedVector<uint64_t> v = Compress(ids);
+    ASSERT_EQ(v.GetBlockCodec(0), BlockCodec::DeltaFrameOfReference);
+    ASSERT_LT(v.MemoryUsage()*6, ids.size()*sizeof(uint64_t));
+}
+
+TEST(CompressedVector, Codecs) {
+    using namespace cstl;
+    // Noisy values around a level: frame of reference wins
+    std::mt19937 rng(2);
+    std::vector<uint32_t> noisy(1000);
+    for (uint32_t& value : noisy)
+        value = 1'000'000 + rng() % 1000;
+    const CompressedVector<uint32_t> v = Compress(noisy);
+    ASSERT_EQ(v.GetBlockCodec(0), BlockCodec::FrameOfReference);
+    ASSERT_LT(v.MemoryUsage()*2, noisy.size()*sizeof(uint32_t));
+    ExpectRoundTrip(noisy);
+
+    // Timestamps with an occasional long pause: the pause makes the frame
+    // of reference wide, the deltas stay small
+    std::vector<uint64_t> timestamps(10000);
+    uint64_t now = 1'700'000'000'000;
+    for (size_t i = 0; i < timestamps.size(); ++i) {
+        now += 1 + rng() % 100 + (i % 128 == 64 ? uint64_t{1} << 40 : 0);
+        timestamps[i] = now;
+    }
+    const CompressedVector<uint64_t> t = Compress(timestamps);
+    ASSERT_EQ(t.GetBlockCodec(6), BlockCodec::DeltaVarint);
+    ASSERT_LT(t.MemoryUsage()*4, timestamps.size()*sizeof(uint64_t));
+    ExpectRoundTrip(timestamps);
+
+    // Evenly spaced: the differences are all equal and take no bits
+    std::vector<int64_t> spaced(1024);
+    for (size_t i = 0; i < spaced.size(); ++i)
+        spaced[i] = 5'000'000'000 - 3*static_cast<int64_t>(i);
+    const CompressedVector<int64_t> s = Compress(spaced);
+    ASSERT_EQ(s.GetBlockCodec(0), BlockCodec::DeltaFrameOfReference);
+    ASSERT_LT(s.MemoryUsage()*20, spaced.size()*sizeof(int64_t));
+    ExpectRoundTrip(spaced);
+
+    std::vector<uint16_t> constant(300, 7);
+    ExpectRoundTrip(constant);
+}
+
+TEST(CompressedVector, AllWidths) {
+    using namespace cstl;
+    std::mt19937_64 rng(3);
+    for (size_t width = 0; width <= 64; ++width) {
+        std::vector<uint64_t> values(CompressedVector<uint64_t>::BLOCK_SIZE*2 + 5);
+        for (uint64_t& value : values)
+            value = width == 64 ? rng() : rng() & ((uint64_t{1} << width) - 1);
+        ExpectRoundTrip(values);
+    }
+}
+
+TEST(CompressedVector, SignedValues) {
+    using namespace cstl;
+    std::mt19937 rng(4);
+    std::vector<int32_t> values(1000);
+    for (int32_t& value : values)
+        value = static_cast<int32_t>(rng() % 2001) - 1000;
+    values[10] = std::numeric_limits<int32_t>::min();
+    values[500] = std::numeric_limits<int32_t>::max();
+    ExpectRoundTrip(values);
+
+    std::vector<int64_t> descending(500);
+    std::iota(descending.rbegin(), descending.rend(), int64_t{-250});
+    ExpectRoundTrip(descending);
+
+    std::vector<int8_t> bytes{-128, 127, 0, -1, 1};
+    ExpectRoundTrip(bytes);
+}
+
+TEST(CompressedVector, Empty) {
+    using namespace cstl;
+    CompressedVector<uint32_t> v;
+    ASSERT_EQ(v.Size(), 0);
+    ASSERT_EQ(v.begin(), v.end());
+    ASSERT_EQ(v.BlockCount(), 0);
+
+    v = {1, 2, 3};
+    ASSERT_EQ(v[2], 3);
+    v.Clear();
+    ASSERT_EQ(v.Size(), 0);
+    ASSERT_EQ(v.MemoryUsage(), 0);
+}
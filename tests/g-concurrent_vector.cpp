@@ -0,0 +1,181 @@
+#include "concurrent_vector/concurrent_vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory_resource>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "counting_fixtures.h"
+
+namespace {
+
+struct ThrowingObj {
+    explicit ThrowingObj(int id) : id(id) {
+        if (id < 0)
+            throw std::runtime_error("Oops");
+        ++num_alive;
+    }
+
+    ThrowingObj(ThrowingObj&& other) noexcept : id(other.id) {
+        ++num_alive;
+    }
+
+    ~ThrowingObj() {
+        --num_alive;
+    }
+
+    int id = 0;
+
+    static inline int num_alive = 0;
+};
+
+}  // namespace
+
+TEST(ConcurrentVector, PushBack) {
+    using namespace cstl;
+
+    const size_t SIZE = 1000;
+
+    ConcurrentVector<std::string, 4> v;
+    ASSERT_EQ(v.Size(), 0);
+    ASSERT_EQ(v.Capacity(), 0);
+
+    v.PushBack("0");
+    const std::string* first = &v[0];
+    for (size_t i = 1; i < SIZE; ++i)
+        ASSERT_EQ(v.EmplaceBack(std::to_string(i)), i);
+
+    ASSERT_EQ(v.Size(), SIZE);
+    ASSERT_GE(v.Capacity(), SIZE);
+    ASSERT_EQ(&v[0], first);
+    for (size_t i = 0; i < SIZE; ++i)
+        ASSERT_EQ(v[i], std::to_string(i));
+
+    v.Clear();
+    ASSERT_EQ(v.Size(), 0);
+    ASSERT_GE(v.Capacity(), SIZE);
+}
+
+TEST(ConcurrentVector, ConcurrentAppend) {
+    using namespace cstl;
+
+    const int THREADS = 8;
+    const int PER_THREAD = 20000;
+
+    ConcurrentVector<int> v;
+    std::atomic<int> num_mismatches = 0;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < THREADS; ++t)
+        producers.emplace_back([&v, &num_mismatches, t] {
+            for (int i = 0; i < PER_THREAD; ++i) {
+                const size_t index = v.EmplaceBack(t*PER_THREAD + i);
+                if (v[index] != t*PER_THREAD + i)
+                    ++num_mismatches;
+            }
+        });
+
+    std::vector<int> batch(PER_THREAD);
+    std::iota(batch.begin(), batch.end(), THREADS*PER_THREAD);
+    const size_t start = v.Append(batch.begin(), batch.end());
+
+    for (auto& producer : producers)
+        producer.join();
+
+    ASSERT_EQ(num_mismatches, 0);
+    ASSERT_EQ(v.Size(), (THREADS + 1)*PER_THREAD);
+    for (int i = 0; i < PER_THREAD; ++i)
+        ASSERT_EQ(v[start + i], THREADS*PER_THREAD + i);
+
+    std::vector<int> values;
+    for (size_t i = 0; i < v.Size(); ++i)
+        values.push_back(v[i]);
+    std::sort(values.begin(), values.end());
+    for (int i = 0; i < (THREADS + 1)*PER_THREAD; ++i)
+        ASSERT_EQ(values[i], i);
+}
+
+TEST(ConcurrentVector, ThrowingConstructor) {
+    using namespace cstl;
+
+    {
+        ConcurrentVector<ThrowingObj> v;
+        v.Reserve(100);
+        ASSERT_GE(v.Capacity(), 100);
+
+        v.EmplaceBack(1);
+        ASSERT_THROW(v.EmplaceBack(-1), std::runtime_error);
+        v.EmplaceBack(2);
+
+        ASSERT_EQ(v.Size(), 2);
+        ASSERT_EQ(v[1].id, 2);
+        ASSERT_EQ(ThrowingObj::num_alive, 2);
+    }
+    ASSERT_EQ(ThrowingObj::num_alive, 0);
+}
+
+TEST(ConcurrentVector, PolymorphicAllocator) {
+    using namespace cstl;
+    CountingResource resource;
+    {
+        ConcurrentVector<std::pmr::string, 4, std::pmr::polymorphic_allocator<std::pmr::string>>
+            v(&resource);
+        for (int i = 0; i < 100; ++i)
+            v.EmplaceBack(std::to_string(i));
+        ASSERT_EQ(v[99], "99");
+        // Segments of 4, 4, 8, 16, 32, 64
+        ASSERT_EQ(resource.bytes_in_use, 128*sizeof(std::pmr::string));
+
+        // Built aside in memory from the same resource, since converting
+        // the strings may throw
+        const std::vector<std::string> words{"a", "b", "c"};
+        const size_t num_allocations = resource.num_allocations;
+        ASSERT_EQ(v.Append(words.begin(), words.end()), 100);
+        ASSERT_EQ(v[102], "c");
+        ASSERT_GT(resource.num_allocations, num_allocations);
+        ASSERT_EQ(resource.bytes_in_use, 128*sizeof(std::pmr::string));
+    }
+    ASSERT_EQ(resource.bytes_in_use, 0);
+}
+
+TEST(ConcurrentVector, SegmentAllocationFailure) {
+    using namespace cstl;
+    // Longer than any small-string buffer
+    const std::string_view text = "a string too long to be stored inline in the object";
+
+    std::byte buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(
+        buffer, sizeof(buffer),
+        std::pmr::null_memory_resource()
+    );
+    ConcurrentVector<std::pmr::string, 4, std::pmr::polymorphic_allocator<std::pmr::string>>
+        v(&arena);
+
+    // The elements are built with the vector's allocator too
+    v.EmplaceBack(text);
+    ASSERT_EQ(v[0].get_allocator().resource(), &arena);
+
+    // Short strings take no memory of their own: the arena runs out while
+    // allocating a segment, which must leave no claimed slot behind
+    size_t size = v.Size();
+    for (;; ++size) {
+        try {
+            v.EmplaceBack("x");
+        } catch (const std::bad_alloc&) {
+            break;
+        }
+        ASSERT_EQ(v.Size(), size + 1);
+    }
+    ASSERT_EQ(v.Size(), size);
+    ASSERT_EQ(v.Capacity(), size);
+    ASSERT_THROW(v.PushBack(std::pmr::string("y")), std::bad_alloc);
+    ASSERT_EQ(v.Size(), size);
+    ASSERT_EQ(v[size - 1], "x");
+}
@@ -0,0 +1,146 @@
+#include "flat_map/flat_map.h"
+#include "flat_map/flat_set.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "counting_fixtures.h"
+
+namespace {
+
+template <typename Entry, typename Pair>
+bool SameEntry(const Entry& entry, const Pair& pair) {
+    return entry.first == pair.first && entry.second == pair.second;
+}
+
+} // namespace
+
+TEST(FlatMap, LowerBound) {
+    using namespace cstl;
+    std::vector<int> keys;
+    for (size_t n = 0; n < 70; ++n) {
+        for (int key = -1; key <= 2*static_cast<int>(n) + 1; ++key) {
+            const size_t expected = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+            ASSERT_EQ(detail::LowerBound(keys.data(), keys.size(), key, std::less<>{}), expected);
+        }
+        keys.push_back(2*n);
+    }
+}
+
+TEST(FlatMap, BulkConstructionAndLookup) {
+    using namespace cstl;
+    FlatMap<int, std::string> map{{3, "c"}, {1, "a"}, {2, "b"}, {1, "x"}, {3, "y"}};
+    ASSERT_EQ(map.Size(), 3);
+    ASSERT_TRUE(std::is_sorted(map.Keys().begin(), map.Keys().end()));
+    ASSERT_EQ(map.At(1), "a");
+    ASSERT_EQ(map.At(3), "c");
+    ASSERT_THROW(map.At(4), std::out_of_range);
+    ASSERT_FALSE(map.Contains(0));
+    ASSERT_EQ(map.Find(5), map.end());
+
+    const auto [key, value] = *map.Find(2);
+    ASSERT_EQ(key, 2);
+    ASSERT_EQ(value, "b");
+
+    Vector<int> keys(1000);
+    Vector<int> values(1000);
+    std::mt19937 rng(42);
+    for (size_t i = 0; i < keys.Size(); ++i) {
+        keys[i] = rng() % 500;
+        values[i] = static_cast<int>(i);
+    }
+    std::map<int, int> expected;
+    for (size_t i = 0; i < keys.Size(); ++i)
+        expected.emplace(keys[i], values[i]);
+
+    FlatMap<int, int> big(std::move(keys), std::move(values));
+    ASSERT_EQ(big.Size(), expected.size());
+    ASSERT_TRUE(std::equal(big.begin(), big.end(), expected.begin(), expected.end(),
+                           [](const auto& lhs, const auto& rhs) { return SameEntry(lhs, rhs); }));
+}
+
+TEST(FlatMap, InsertAndErase) {
+    using namespace cstl;
+    Obj::ResetCounters();
+    {
+        FlatMap<int, Obj> map;
+        for (int key : {5, 1, 9, 3, 7})
+            ASSERT_TRUE(map.TryEmplace(key, key*10).second);
+        ASSERT_FALSE(map.TryEmplace(3, 0).second);
+        ASSERT_EQ(map.At(3).id, 30);
+        ASSERT_EQ(map[4].id, 0);
+        ASSERT_EQ(map.Size(), 6);
+
+        ASSERT_EQ(map.Erase(4), 1);
+        ASSERT_EQ(map.Erase(4), 0);
+        auto it = map.Erase(map.Find(5));
+        ASSERT_EQ(it->first, 7);
+        it->second.id = 70;
+        ASSERT_EQ(map.Find(9)->second.id, 90);
+        map.Find(9)->second.id = 91;
+        ASSERT_EQ(std::as_const(map).Find(9)->second.id, 91);
+
+        const std::vector<int> keys(map.Keys().begin(), map.Keys().end());
+        ASSERT_EQ(keys, (std::vector<int>{1, 3, 7, 9}));
+        ASSERT_EQ(map.Values()[2].id, 70);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 4);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+    // Lvalue arguments are copied, also when the key sorts last
+    FlatMap<int, std::string> names;
+    std::string name(40, 'a');
+    names.TryEmplace(1, name);
+    names.TryEmplace(2, name);
+    ASSERT_EQ(name, std::string(40, 'a'));
+    ASSERT_EQ(names.At(2), name);
+}
+
+TEST(FlatMap, InsertBatch) {
+    using namespace cstl;
+    FlatMap<int, std::string> map{{2, "b"}, {4, "d"}, {6, "f"}};
+    const std::vector<std::pair<int, std::string>> batch{
+        {7, "g"}, {1, "a"}, {4, "x"}, {3, "c"}, {1, "y"}
+    };
+    map.InsertBatch(batch);
+
+    const std::map<int, std::string> expected{
+        {1, "a"}, {2, "b"}, {3, "c"}, {4, "d"}, {6, "f"}, {7, "g"}
+    };
+    ASSERT_TRUE(std::equal(map.begin(), map.end(), expected.begin(), expected.end(),
+                           [](const auto& lhs, const auto& rhs) { return SameEntry(lhs, rhs); }));
+
+    map.InsertBatch(std::vector<std::pair<int, std::string>>{});
+    ASSERT_EQ(map.Size(), 6);
+}
+
+TEST(FlatSet, Basic) {
+    using namespace cstl;
+    FlatSet<std::string> set{"pear", "apple", "fig", "apple"};
+    ASSERT_EQ(set.Size(), 3);
+    ASSERT_TRUE(set.Contains("fig"));
+    ASSERT_FALSE(set.Contains("kiwi"));
+
+    ASSERT_TRUE(set.Insert("kiwi").second);
+    ASSERT_FALSE(set.Insert("kiwi").second);
+    ASSERT_EQ(*set.LowerBound("g"), "kiwi");
+
+    set.InsertBatch(std::vector<std::string>{"plum", "fig", "banana", "plum"});
+    const std::vector<std::string> expected{"apple", "banana", "fig", "kiwi", "pear", "plum"};
+    ASSERT_TRUE(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+
+    ASSERT_EQ(set.Erase("banana"), 1);
+    ASSERT_EQ(*set.Erase(set.Find("kiwi")), "pear");
+    ASSERT_EQ(set.Size(), 4);
+
+    FlatSet<int, std::greater<int>> descending(Vector<int>(5));
+    ASSERT_EQ(descending.Size(), 1);
+    descending.InsertBatch(std::vector<int>{3, 1, 2});
+    ASSERT_TRUE(std::is_sorted(descending.begin(), descending.end(), std::greater<int>{}));
+}
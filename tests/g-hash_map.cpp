@@ -0,0 +1,261 @@
+#include "hash_map/hash_map.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "counting_fixtures.h"
+
+namespace {
+
+struct StringHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view s) const noexcept {
+        return std::hash<std::string_view>{}(s);
+    }
+};
+
+struct ObjHash {
+    size_t operator()(const Obj& obj) const noexcept {
+        return obj.id;
+    }
+};
+
+// Throws while hashing the key `throw_on`
+struct ThrowingHash {
+    size_t operator()(int key) const {
+        if (key == throw_on)
+            throw std::runtime_error("hash");
+        return key;
+    }
+
+    static inline int throw_on = -1;
+};
+
+struct ObjEqual {
+    bool operator()(const Obj& lhs, const Obj& rhs) const noexcept {
+        return lhs.id == rhs.id;
+    }
+};
+
+} // namespace
+
+TEST(HashMap, Groups) {
+    using namespace cstl::detail;
+    std::mt19937 rng(7);
+    for (int round = 0; round < 100; ++round) {
+        Ctrl ctrl[16];
+        for (Ctrl& c : ctrl) {
+            const int kind = rng() % 4;
+            c = kind == 0 ? CTRL_EMPTY
+                : kind == 1 ? CTRL_DELETED
+                : kind == 2 ? CTRL_SENTINEL
+                : static_cast<Ctrl>(rng() % 4);
+        }
+
+        const ScalarGroup scalar(ctrl);
+        const Group group(ctrl);
+        for (Ctrl h2 = 0; h2 < 4; ++h2)
+            ASSERT_TRUE(scalar.Match(h2) == group.Match(h2));
+        ASSERT_TRUE(scalar.MatchEmpty() == group.MatchEmpty());
+        ASSERT_TRUE(scalar.MatchEmptyOrDeleted() == group.MatchEmptyOrDeleted());
+
+        for (const uint32_t i : group.Match(1))
+            ASSERT_EQ(ctrl[i], 1);
+    }
+}
+
+TEST(HashMap, AgainstUnorderedMap) {
+    using namespace cstl;
+    HashMap<uint64_t, uint64_t> map;
+    std::unordered_map<uint64_t, uint64_t> expected;
+
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < 200000; ++i) {
+        const uint64_t key = rng() % 5000;
+        switch (rng() % 4) {
+        case 0:
+            ASSERT_EQ(map.Erase(key), expected.erase(key));
+            break;
+        case 1:
+            ASSERT_EQ(map.Contains(key), expected.contains(key));
+            break;
+        default:
+            ASSERT_EQ(map.TryEmplace(key, i).second, expected.emplace(key, i).second);
+        }
+        ASSERT_EQ(map.Size(), expected.size());
+    }
+
+    size_t count = 0;
+    for (const auto& [key, value] : map) {
+        ASSERT_EQ(expected.at(key), value);
+        ++count;
+    }
+    ASSERT_EQ(count, expected.size());
+
+    // Keys the identity hash maps to the same low bits
+    HashMap<uint64_t, int> strided;
+    for (uint64_t i = 0; i < 10000; ++i)
+        strided[i << 20] = static_cast<int>(i);
+    for (uint64_t i = 0; i < 10000; ++i)
+        ASSERT_EQ(strided.At(i << 20), static_cast<int>(i));
+    ASSERT_THROW(strided.At(1), std::out_of_range);
+}
+
+TEST(HashMap, Reserve) {
+    using namespace cstl;
+    HashMap<int, int> map;
+    ASSERT_EQ(map.Capacity(), 0);
+    ASSERT_EQ(map.begin(), map.end());
+    ASSERT_EQ(map.Find(1), map.end());
+
+    map.Reserve(1000);
+    const size_t capacity = map.Capacity();
+    ASSERT_GE(capacity, 1000);
+    ASSERT_EQ((capacity + 1) & capacity, 0);
+
+    map[-1] = 0;
+    const int* address = &map.At(-1);
+    for (int i = 0; i < 999; ++i)
+        map[i] = i;
+    ASSERT_EQ(map.Capacity(), capacity);
+    ASSERT_EQ(&map.At(-1), address);
+
+    // Churn leaves tombstones, which rehashing at the same size drops
+    for (int round = 0; round < 50; ++round) {
+        for (int i = 0; i < 999; ++i)
+            map.Erase(i);
+        for (int i = 0; i < 999; ++i)
+            map[i + 1000*round] = i;
+        for (int i = 0; i < 999; ++i)
+            map.Erase(i + 1000*round);
+        for (int i = 0; i < 999; ++i)
+            map[i] = i;
+    }
+    ASSERT_EQ(map.Capacity(), capacity);
+    ASSERT_EQ(map.Size(), 1000);
+
+    map.Clear();
+    ASSERT_EQ(map.Size(), 0);
+    ASSERT_EQ(map.begin(), map.end());
+    ASSERT_EQ(map.Capacity(), capacity);
+}
+
+TEST(HashMap, HeterogeneousLookup) {
+    using namespace cstl;
+    HashMap<std::string, int, StringHash, std::equal_to<>> map{{"one", 1}, {"two", 2}};
+    map.TryEmplace(std::string(50, 'x'), 50);
+
+    const std::string_view key = "two";
+    ASSERT_EQ(map.At(key), 2);
+    ASSERT_TRUE(map.Contains("one"));
+    ASSERT_EQ(map.Find(std::string_view(std::string(50, 'x')))->second, 50);
+    ASSERT_EQ(map.Erase("one"), 1);
+    ASSERT_FALSE(map.Contains(std::string_view("one")));
+    ASSERT_EQ(map.Size(), 2);
+
+    map.Erase(map.Find("two"));
+    const auto& const_map = map;
+    map.Erase(const_map.Find(std::string(50, 'x')));
+    ASSERT_EQ(map.Size(), 0);
+}
+
+TEST(HashMap, Lifetime) {
+    using namespace cstl;
+    Obj::ResetCounters();
+    {
+        HashMap<Obj, Obj, ObjHash, ObjEqual> map;
+        for (int i = 0; i < 1000; ++i)
+            map.TryEmplace(Obj(i), i*2);
+        for (int i = 0; i < 1000; i += 2)
+            map.Erase(Obj(i));
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 1000);
+
+        // The value refers to an element while the insertion rehashes
+        HashMap<Obj, Obj, ObjHash, ObjEqual> copy(map);
+        for (int i = 1000; copy.Size() < copy.Capacity() - copy.Capacity()/8; ++i)
+            copy.TryEmplace(Obj(i), i);
+        copy.TryEmplace(Obj(-1), copy.At(Obj(1)));
+        ASSERT_EQ(copy.At(Obj(-1)).id, 2);
+
+        auto it = map.Erase(map.Find(Obj(1)));
+        while (it != map.end())
+            it = map.Erase(it);
+        ASSERT_EQ(static_cast<size_t>(std::distance(map.begin(), map.end())), map.Size());
+        for (const auto& [key, value] : map)
+            ASSERT_EQ(value.id, key.id*2);
+
+        map = copy;
+        ASSERT_EQ(map.Size(), copy.Size());
+        HashMap<Obj, Obj, ObjHash, ObjEqual> moved(std::move(copy));
+        ASSERT_EQ(copy.Size(), 0);
+        ASSERT_EQ(moved.Size(), map.Size());
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+}
+
+TEST(HashMap, RehashFailure) {
+    using namespace cstl;
+    HashMap<int, std::string, ThrowingHash> map;
+    for (int i = 0; i < 10; ++i)
+        map.TryEmplace(i, std::string(50, 'a' + i));
+
+    // The elements move without throwing, so a hash failing halfway must
+    // not leave earlier ones moved-from
+    ThrowingHash::throw_on = 7;
+    const size_t capacity = map.Capacity();
+    ASSERT_THROW(map.Reserve(1000), std::runtime_error);
+    ThrowingHash::throw_on = -1;
+
+    ASSERT_EQ(map.Capacity(), capacity);
+    ASSERT_EQ(map.Size(), 10);
+    for (int i = 0; i < 10; ++i)
+        ASSERT_EQ(map.At(i), std::string(50, 'a' + i));
+}
+
+TEST(HashMap, AssignmentKeepsAllocator) {
+    using namespace cstl;
+    using PmrMap = HashMap<int, std::string, std::hash<int>, std::equal_to<int>,
+                           std::pmr::polymorphic_allocator<std::pair<const int, std::string>>>;
+    CountingResource lhs_resource;
+    CountingResource rhs_resource;
+
+    PmrMap lhs({{-1, "old"}}, &lhs_resource);
+    PmrMap rhs(&rhs_resource);
+    for (int i = 0; i < 100; ++i)
+        rhs.TryEmplace(i, std::string(50, 'a' + i % 26));
+    const size_t rhs_bytes = rhs_resource.bytes_in_use;
+
+    // Allocators that do not propagate stay put; the elements are copied
+    // or moved over one by one
+    lhs = rhs;
+    ASSERT_EQ(lhs.GetAllocator().resource(), &lhs_resource);
+    ASSERT_EQ(lhs.Size(), 100);
+    ASSERT_FALSE(lhs.Contains(-1));
+    ASSERT_EQ(lhs.At(30), std::string(50, 'e'));
+    ASSERT_EQ(rhs_resource.bytes_in_use, rhs_bytes);
+
+    lhs.Clear();
+    lhs = std::move(rhs);
+    ASSERT_EQ(lhs.GetAllocator().resource(), &lhs_resource);
+    ASSERT_EQ(lhs.Size(), 100);
+    ASSERT_EQ(lhs.At(99), std::string(50, 'v'));
+    ASSERT_EQ(rhs_resource.bytes_in_use, rhs_bytes);
+
+    // Equal allocators exchange the tables
+    lhs = PmrMap({{7, "seven"}}, &lhs_resource);
+    ASSERT_EQ(lhs.Size(), 1);
+    ASSERT_EQ(lhs.At(7), "seven");
+    static_assert(!std::is_nothrow_move_assignable_v<PmrMap>);
+    static_assert(std::is_nothrow_move_assignable_v<HashMap<int, int>>);
+}
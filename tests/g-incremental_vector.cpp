@@ -0,0 +1,160 @@
+#include "incremental_vector/incremental_vector.h"
+
+#include <algorithm>
+#include <memory_resource>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "counting_fixtures.h"
+
+TEST(IncrementalVector, PushBackAndIndexing) {
+    using namespace cstl;
+    IncrementalVector<int, 4> v;
+
+    bool saw_migration = false;
+    for (int i = 0; i < 1000; ++i) {
+        v.PushBack(i);
+        saw_migration |= v.IsMigrating();
+        for (int j = std::max(0, i - 20); j <= i; ++j)
+            ASSERT_EQ(v[j], j);
+    }
+    ASSERT_TRUE(saw_migration);
+    ASSERT_EQ(v.Size(), 1000);
+
+    std::vector<int> expected(1000);
+    std::iota(expected.begin(), expected.end(), 0);
+    ASSERT_TRUE(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+    v.FinishMigration();
+    ASSERT_FALSE(v.IsMigrating());
+}
+
+TEST(IncrementalVector, BoundedMovesPerOperation) {
+    using namespace cstl;
+    Obj::ResetCounters();
+    {
+        IncrementalVector<Obj, 8> v;
+        for (int i = 0; i < 5000; ++i) {
+            const int moved_before = Obj::num_moved;
+            v.EmplaceBack(i);
+            ASSERT_LE(Obj::num_moved - moved_before, 8);
+        }
+        for (int i = 0; i < 5000; ++i)
+            ASSERT_EQ(v[i].id, i);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 5000);
+
+        while (v.Size() > 10) {
+            const int moved_before = Obj::num_moved;
+            v.PopBack();
+            ASSERT_LE(Obj::num_moved - moved_before, 8);
+        }
+        ASSERT_EQ(v[9].id, 9);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 10);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+}
+
+TEST(IncrementalVector, PopBackIntoOldBuffer) {
+    using namespace cstl;
+    Obj::ResetCounters();
+    {
+        IncrementalVector<Obj, 1> v;
+        for (int i = 0; i < 64; ++i)
+            v.EmplaceBack(i);
+        v.Reserve(1024);
+        ASSERT_TRUE(v.IsMigrating());
+
+        // Elements come off the end of the old buffer faster than they move
+        v.Resize(8);
+        ASSERT_EQ(v.Size(), 8);
+        for (int i = 0; i < 8; ++i)
+            ASSERT_EQ(v[i].id, i);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 8);
+
+        v.Clear();
+        ASSERT_FALSE(v.IsMigrating());
+        ASSERT_EQ(v.Capacity(), 1024);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+}
+
+TEST(IncrementalVector, EmplaceBackOwnElement) {
+    using namespace cstl;
+    IncrementalVector<std::string, 2> v;
+    v.PushBack(std::string(100, 'a'));
+    for (int i = 0; i < 200; ++i)
+        v.PushBack(v[0]);
+
+    ASSERT_EQ(v.Size(), 201);
+    ASSERT_TRUE(std::all_of(v.begin(), v.end(),
+                            [](const std::string& s) { return s == std::string(100, 'a'); }));
+}
+
+TEST(IncrementalVector, CopyAndMove) {
+    using namespace cstl;
+    IncrementalVector<std::string, 1> v;
+    for (int i = 0; i < 100; ++i)
+        v.PushBack(std::to_string(i));
+    ASSERT_TRUE(v.IsMigrating());
+
+    IncrementalVector<std::string, 1> copy(v);
+    ASSERT_TRUE(std::equal(v.begin(), v.end(), copy.begin(), copy.end()));
+
+    IncrementalVector<std::string, 1> moved(std::move(v));
+    ASSERT_EQ(v.Size(), 0);
+    ASSERT_TRUE(std::equal(moved.begin(), moved.end(), copy.begin(), copy.end()));
+
+    v = moved;
+    moved.Clear();
+    ASSERT_EQ(v[57], "57");
+
+    std::sort(v.begin(), v.end());
+    ASSERT_TRUE(std::is_sorted(v.cbegin(), v.cend()));
+}
+
+TEST(IncrementalVector, AssignmentKeepsAllocator) {
+    using namespace cstl;
+    using PmrVector = IncrementalVector<std::pmr::string, 1,
+                                        std::pmr::polymorphic_allocator<std::pmr::string>>;
+    // Longer than any small-string buffer
+    const std::string_view text = "a string too long to be stored inline in the object";
+    CountingResource lhs_resource;
+    CountingResource rhs_resource;
+
+    const auto uses = [](const PmrVector& v, const std::pmr::memory_resource* resource) {
+        return v.GetAllocator().resource() == resource
+               && std::all_of(v.begin(), v.end(), [&](const std::pmr::string& s) {
+                      return s.get_allocator().resource() == resource;
+                  });
+    };
+
+    PmrVector lhs(&lhs_resource);
+    PmrVector rhs(&rhs_resource);
+    lhs.EmplaceBack("old");
+    for (int i = 0; i < 50; ++i)
+        rhs.EmplaceBack(text);
+    ASSERT_TRUE(rhs.IsMigrating());
+    ASSERT_TRUE(uses(rhs, &rhs_resource));
+
+    // Allocators that do not propagate stay put; the elements are copied
+    // or moved over one by one
+    lhs = rhs;
+    ASSERT_EQ(lhs.Size(), 50);
+    ASSERT_EQ(lhs[49], text);
+    ASSERT_TRUE(uses(lhs, &lhs_resource));
+
+    lhs.Clear();
+    lhs = std::move(rhs);
+    ASSERT_EQ(lhs.Size(), 50);
+    ASSERT_EQ(lhs[0], text);
+    ASSERT_TRUE(uses(lhs, &lhs_resource));
+
+    rhs.Clear();
+    ASSERT_EQ(rhs_resource.bytes_in_use, rhs.Capacity()*sizeof(std::pmr::string));
+    static_assert(!std::is_nothrow_move_assignable_v<PmrVector>);
+    static_assert(std::is_nothrow_move_assignable_v<IncrementalVector<int>>);
+}
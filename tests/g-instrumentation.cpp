@@ -0,0 +1,136 @@
+#define CSTL_INSTRUMENTATION
+#include "instrumentation/instrumentation.h"
+#include "matrix/matrix.h"
+#include "simple_vector/simple_vector.h"
+#include "single_linked_list/single_linked_list.h"
+#include "vector/vector.h"
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+TEST(Instrumentation, Vector) {
+    using namespace cstl;
+    instrumentation::Reset();
+    const auto& counters = instrumentation::For<Vector<int>>();
+
+    {
+        Vector<int> v;
+        for (int i = 0; i < 100; ++i)
+            v.PushBack(i);
+
+        // Doubling from 1 to 128: one allocation and seven reallocations
+        ASSERT_EQ(counters.allocations, 8);
+        ASSERT_EQ(counters.reallocations, 7);
+        ASSERT_EQ(counters.relocated_elements, 1 + 2 + 4 + 8 + 16 + 32 + 64);
+        ASSERT_EQ(counters.peak_capacity, 128);
+        ASSERT_EQ(counters.bytes_allocated, (255)*sizeof(int));
+
+        Vector<int> copy(v);
+        ASSERT_EQ(counters.allocations, 9);
+        ASSERT_EQ(counters.deallocations, 7);
+    }
+    ASSERT_EQ(counters.deallocations, 9);
+    ASSERT_EQ(instrumentation::Global().allocations, 9);
+}
+
+TEST(Instrumentation, SimpleVector) {
+    using namespace cstl;
+    instrumentation::Reset();
+    const auto& counters = instrumentation::For<SimpleVector<int>>();
+
+    {
+        SimpleVector<int> v(4, 0);
+        ASSERT_EQ(counters.allocations, 1);
+
+        v.Reserve(16);
+        ASSERT_EQ(counters.reallocations, 1);
+        ASSERT_EQ(counters.relocated_elements, 4);
+        ASSERT_EQ(counters.peak_capacity, 16);
+
+        // Inserting within capacity reallocates nothing
+        for (int i = 0; i < 12; ++i)
+            v.Insert(v.begin(), i);
+        ASSERT_EQ(counters.reallocations, 1);
+        v.PushBack(12);
+        ASSERT_EQ(counters.reallocations, 2);
+        ASSERT_EQ(counters.peak_capacity, 32);
+    }
+    ASSERT_EQ(counters.deallocations, counters.allocations);
+}
+
+TEST(Instrumentation, SingleLinkedList) {
+    using namespace cstl;
+    instrumentation::Reset();
+    const auto& counters = instrumentation::For<SingleLinkedList<int>>();
+
+    {
+        SingleLinkedList<int> list{1, 2, 3};
+        ASSERT_EQ(counters.allocations, 3);
+        list.PopFront();
+        ASSERT_EQ(counters.deallocations, 1);
+    }
+    ASSERT_EQ(counters.deallocations, 3);
+}
+
+TEST(Instrumentation, Matrix) {
+    using namespace cstl;
+    instrumentation::Reset();
+    const auto& counters = instrumentation::For<Matrix<double>>();
+
+    {
+        Matrix<double> m(3, 4);
+        ASSERT_EQ(counters.allocations, 1);
+        ASSERT_EQ(counters.bytes_allocated, 12*sizeof(double));
+
+        m.T();
+        ASSERT_EQ(counters.allocations, 2);
+    }
+    ASSERT_EQ(counters.deallocations, 2);
+
+    // Assignment releases the old buffers, moves allocate nothing
+    instrumentation::Reset();
+    {
+        Matrix<double> a(3, 4);
+        Matrix<double> b(5, 5);
+        b.T();
+        b = a;
+        ASSERT_EQ(counters.allocations, 4);
+        ASSERT_EQ(counters.deallocations, 2);
+
+        Matrix<double> c(std::move(a));
+        a = std::move(b);
+        c = std::move(a);
+        ASSERT_EQ(counters.allocations, 4);
+        ASSERT_EQ(counters.deallocations, 3);
+    }
+    ASSERT_EQ(counters.allocations, counters.deallocations);
+}
+
+TEST(Instrumentation, DumpJson) {
+    using namespace cstl;
+    instrumentation::Reset();
+
+    Vector<char> v(10);
+    std::ostringstream out;
+    instrumentation::DumpJson(out);
+
+    const std::string json = out.str();
+    ASSERT_EQ(json.rfind("{\"global\": {\"allocations\": 1,", 0), 0);
+    ASSERT_NE(json.find("\"cstl::Vector<char"), std::string::npos);
+    ASSERT_NE(json.find("\"peak_capacity\": 10}"), std::string::npos);
+    ASSERT_EQ(json.back(), '}');
+}
+
+TEST(Instrumentation, ConstantEvaluation) {
+    using namespace cstl;
+
+    // Hooks are skipped in constant evaluation
+    static_assert([] {
+        Vector<int> v(4);
+        v.PushBack(1);
+        Matrix<int> m(2, 2);
+        return v.Size() + m.GetShape().rows;
+    }() == 7);
+}
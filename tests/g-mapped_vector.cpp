@@ -0,0 +1,145 @@
+#include "mapped_vector/mapped_vector.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+struct Point {
+    int32_t x;
+    int32_t y;
+};
+
+// Path in the test temp directory, removed on scope exit
+struct TempFile {
+    explicit TempFile(const std::string& name)
+        : path(std::filesystem::path(testing::TempDir()) / name)
+    {
+        std::filesystem::remove(path);
+    }
+
+    ~TempFile() {
+        std::filesystem::remove(path);
+    }
+
+    std::filesystem::path path;
+};
+
+} // namespace
+
+TEST(MappedVector, Create) {
+    using namespace cstl;
+    const TempFile file("mapped_vector_create.bin");
+
+    MappedVector<int> v(file.path);
+    ASSERT_EQ(v.Size(), 0);
+    ASSERT_GT(v.Capacity(), 0);
+    ASSERT_EQ(v.begin(), v.end());
+    ASSERT_TRUE(std::filesystem::exists(file.path));
+}
+
+TEST(MappedVector, PushBackAndReopen) {
+    using namespace cstl;
+    const TempFile file("mapped_vector_reopen.bin");
+    const size_t SIZE = 100'000;
+
+    {
+        MappedVector<uint64_t> v(file.path);
+        for (size_t i = 0; i < SIZE; ++i)
+            v.PushBack(i*i);
+        ASSERT_EQ(v.Size(), SIZE);
+        ASSERT_GE(v.Capacity(), SIZE);
+        v.Sync();
+    }
+    {
+        MappedVector<uint64_t> v(file.path);
+        ASSERT_EQ(v.Size(), SIZE);
+        for (size_t i = 0; i < SIZE; ++i)
+            ASSERT_EQ(v[i], i*i);
+
+        v.PopBack();
+        v[0] = 42;
+        v.Sync(0, 1);
+    }
+    {
+        const MappedVector<uint64_t> v(file.path);
+        ASSERT_EQ(v.Size(), SIZE - 1);
+        ASSERT_EQ(v[0], 42);
+        ASSERT_EQ(*(v.end() - 1), (SIZE - 2)*(SIZE - 2));
+    }
+}
+
+TEST(MappedVector, EmplaceAndResize) {
+    using namespace cstl;
+    const TempFile file("mapped_vector_resize.bin");
+
+    MappedVector<Point> v(file.path);
+    const Point& p = v.EmplaceBack(Point{1, 2});
+    ASSERT_EQ(p.x, 1);
+    ASSERT_EQ(p.y, 2);
+
+    // Self-reference survives the remap done by growth
+    for (int i = 0; i < 5000; ++i)
+        v.PushBack(v[0]);
+    ASSERT_EQ(v.Size(), 5001);
+    ASSERT_EQ(v[5000].y, 2);
+
+    v.Resize(2);
+    v.Resize(10);
+    ASSERT_EQ(v[1].x, 1);
+    ASSERT_EQ(v[9].x, 0);
+    ASSERT_EQ(v[9].y, 0);
+
+    v.Reserve(100'000);
+    ASSERT_GE(v.Capacity(), 100'000);
+    ASSERT_EQ(v.Size(), 10);
+
+    v.Clear();
+    v.Resize(0);
+    ASSERT_EQ(v.Size(), 0);
+}
+
+TEST(MappedVector, Move) {
+    using namespace cstl;
+    const TempFile file("mapped_vector_move.bin");
+
+    MappedVector<int> v(file.path);
+    v.Resize(10);
+    std::iota(v.begin(), v.end(), 0);
+
+    MappedVector<int> moved(std::move(v));
+    ASSERT_EQ(v.Size(), 0);
+    ASSERT_EQ(moved.Size(), 10);
+    ASSERT_EQ(moved[9], 9);
+
+    // A moved-from vector has no mapping
+    v.Clear();
+    v.Resize(0);
+    ASSERT_EQ(v.Size(), 0);
+    ASSERT_EQ(v.begin(), v.end());
+    ASSERT_THROW(v.PushBack(1), std::logic_error);
+    ASSERT_THROW(v.Resize(1), std::logic_error);
+}
+
+TEST(MappedVector, RejectsForeignFiles) {
+    using namespace cstl;
+    const TempFile file("mapped_vector_foreign.bin");
+
+    {
+        MappedVector<int32_t> v(file.path);
+        v.PushBack(1);
+    }
+    ASSERT_THROW(MappedVector<int64_t>{file.path}, std::runtime_error);
+
+    std::ofstream(file.path, std::ios::trunc) << std::string(100, 'x');
+    ASSERT_THROW(MappedVector<int32_t>{file.path}, std::runtime_error);
+
+    const TempFile dir("mapped_vector_missing");
+    ASSERT_THROW(MappedVector<int32_t>{dir.path / "file.bin"}, std::system_error);
+}
@@ -0,0 +1,47 @@
+#include "matrix/matrix.h"
+
+#include <array>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+TEST(Matrix, Transpose) {
+    using namespace cstl;
+    const int data[] = {0, 1, 2, 3, 4, 5};
+    Matrix<int> m(2, 3, data);
+
+    const Matrix<int> t = std::as_const(m).T();
+    ASSERT_EQ(t.GetShape().rows, 3);
+    ASSERT_EQ(t.GetShape().cols, 2);
+    ASSERT_TRUE(std::equal(t.GetData(), t.GetData() + 6,
+                           std::array{0, 3, 1, 4, 2, 5}.begin()));
+
+    // In place, twice
+    m.T().T();
+    ASSERT_EQ(m.GetShape().rows, 2);
+    ASSERT_EQ(m[1][2], 5);
+
+    Matrix<int> unwritten({2, 3}, default_init);
+    std::copy(data, data + 6, unwritten.GetData());
+    ASSERT_EQ(unwritten[1][2], 5);
+}
+
+TEST(Matrix, Constexpr) {
+    using namespace cstl;
+
+    // A small matrix built and transposed at compile time
+    static constexpr auto transposed = [] {
+        Matrix<int> m(Shape{2, 3});
+        for (size_t i = 0; i < 2; ++i)
+            for (size_t j = 0; j < 3; ++j)
+                m[i][j] = static_cast<int>(10*i + j);
+
+        Matrix<int> copy(m);
+        copy.T();
+
+        std::array<int, 6> elements{};
+        std::copy(copy.GetData(), copy.GetData() + 6, elements.begin());
+        return elements;
+    }();
+    static_assert(transposed == std::array{0, 10, 1, 11, 2, 12});
+}
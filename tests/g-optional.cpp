@@ -1,5 +1,7 @@
 #include "optional/optional.h"
 
+#include <string>
+
 #include <gtest/gtest.h>
 
 using namespace cstl;
@@ -232,6 +234,13 @@ TEST(Optional, Emplace) {
     ASSERT_TRUE(o.HasValue());
     ASSERT_EQ(o->i, 3);
     ASSERT_EQ(*(o->p), 4);
+
+    // The arguments may refer to the current value
+    Optional<std::string> s(std::string(40, 'a'));
+    s.Emplace(*s);
+    ASSERT_EQ(*s, std::string(40, 'a'));
+    s.Emplace(s->begin(), s->begin() + 20);
+    ASSERT_EQ(*s, std::string(20, 'a'));
 }
 
 TEST(Optional, RefQualifiedMethodOverloading) {
@@ -286,7 +295,25 @@ TEST(Optional, RefQualifiedMethodOverloading) {
     }
 }
 
+TEST(Optional, Constexpr) {
+    static constexpr Optional<int> empty;
+    static constexpr Optional<int> answer(42);
+    static_assert(!empty.HasValue());
+    static_assert(answer.HasValue() && *answer == 42);
+
+    // Non-trivial values may live within a constant evaluation
+    static constexpr size_t length = [] {
+        Optional<std::string> o;
+        o = std::string("constexpr");
+        Optional<std::string> copy(o);
+        o.Reset();
+        copy.Emplace(3, 'x');
+        return copy->size() + o.HasValue();
+    }();
+    static_assert(length == 3);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}
@@ -0,0 +1,143 @@
+#include "matrix/matrix.h"
+#include "parallel/parallel.h"
+#include "vector/vector.h"
+
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// Runs the tasks in reverse order on the calling thread and counts them
+struct CountingExecutor {
+    std::atomic<size_t>* calls;
+    std::atomic<size_t>* tasks;
+
+    void operator()(size_t count, const cstl::parallel::Task& task) const {
+        ++*calls;
+        *tasks += count;
+        for (size_t i = count; i-- > 0;)
+            task(i);
+    }
+};
+
+// Copying may throw, so bulk copies of it must not be split into tasks
+struct Label {
+    int value;
+
+    explicit Label(int value) noexcept
+        : value(value) {
+    }
+
+    Label(const Label& other)
+        : value(other.value) {
+    }
+
+    Label& operator=(const Label&) = default;
+};
+
+// Installs `options` for the lifetime of the guard
+class OptionsGuard {
+public:
+    explicit OptionsGuard(cstl::parallel::Options options)
+        : previous_(cstl::parallel::SetOptions(std::move(options))) {
+    }
+
+    ~OptionsGuard() {
+        cstl::parallel::SetOptions(std::move(previous_));
+    }
+
+private:
+    cstl::parallel::Options previous_;
+};
+
+} // namespace
+
+TEST(Parallel, Chunks) {
+    using namespace cstl;
+    std::atomic<size_t> calls = 0, tasks = 0;
+    OptionsGuard guard({0, 8, CountingExecutor{&calls, &tasks}});
+
+    constexpr size_t count = 100'000;
+    std::vector<uint32_t> source(count);
+    std::iota(source.begin(), source.end(), 0);
+
+    std::vector<uint32_t> copy(count);
+    parallel::CopyN(source.data(), count, copy.data());
+    ASSERT_EQ(copy, source);
+    ASSERT_EQ(calls, 1);
+    ASSERT_GT(tasks, 1);
+    ASSERT_LE(tasks, 8);
+
+    parallel::FillN(copy.data(), count, 7u);
+    ASSERT_EQ(std::count(copy.begin(), copy.end(), 7u), count);
+
+    // Smaller than a page: not worth a second task
+    parallel::FillN(copy.data(), 100, 1u);
+    ASSERT_EQ(calls, 2);
+    ASSERT_EQ(std::count(copy.begin(), copy.end(), 1u), 100);
+}
+
+TEST(Parallel, Threshold) {
+    using namespace cstl;
+    std::atomic<size_t> calls = 0, tasks = 0;
+    OptionsGuard guard({1 << 20, 4, CountingExecutor{&calls, &tasks}});
+
+    Vector<int> small(1000);
+    ASSERT_EQ(calls, 0);
+
+    Vector<int> large((1 << 20)/sizeof(int));
+    ASSERT_EQ(calls, 1);
+    ASSERT_EQ(std::count(large.begin(), large.end(), 0), large.Size());
+}
+
+TEST(Parallel, DefaultExecutor) {
+    using namespace cstl;
+    OptionsGuard guard({0, 4, {}});
+
+    Vector<uint64_t> v(1 << 16);
+    std::iota(v.begin(), v.end(), 0);
+
+    Vector<uint64_t> copy(v);
+    ASSERT_TRUE(std::equal(v.begin(), v.end(), copy.begin(), copy.end()));
+
+    copy.Resize(1 << 17);
+    ASSERT_EQ(copy[(1 << 16) - 1], (1 << 16) - 1);
+    ASSERT_EQ(std::count(copy.begin() + (1 << 16), copy.end(), 0), 1 << 16);
+}
+
+TEST(Parallel, Matrix) {
+    using namespace cstl;
+    std::atomic<size_t> calls = 0, tasks = 0;
+    OptionsGuard guard({0, 4, CountingExecutor{&calls, &tasks}});
+
+    Matrix<double> m({256, 512}, 1.5);
+    ASSERT_EQ(calls, 1);
+    ASSERT_TRUE(std::all_of(m.GetData(), m.GetData() + 256*512,
+                            [](double x) { return x == 1.5; }));
+
+    m[3][4] = -1;
+    Matrix<double> copy(m);
+    ASSERT_EQ(calls, 2);
+    ASSERT_EQ(copy[3][4], -1);
+    ASSERT_TRUE(std::equal(m.GetData(), m.GetData() + 256*512, copy.GetData()));
+}
+
+TEST(Parallel, ThrowingTypesStaySequential) {
+    using namespace cstl;
+    std::atomic<size_t> calls = 0, tasks = 0;
+    OptionsGuard guard({0, 4, CountingExecutor{&calls, &tasks}});
+
+    // Default construction of std::string cannot throw, copying can
+    Vector<std::string> v(10'000);
+    const size_t before = calls;
+    Vector<std::string> copy(v);
+    Matrix<Label> m({100, 100}, Label(7));
+    ASSERT_EQ(calls, before);
+    ASSERT_EQ(copy.Size(), 10'000);
+    ASSERT_EQ(m[99][99].value, 7);
+}
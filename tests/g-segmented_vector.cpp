@@ -0,0 +1,200 @@
+#include "segmented_vector/segmented_vector.h"
+
+#include <algorithm>
+#include <memory_resource>
+#include <memory_resource>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "counting_fixtures.h"
+
+TEST(SegmentedVector, StableAddresses) {
+    using namespace cstl;
+
+    const int SIZE = 1000;
+    const size_t BLOCK = 16;
+
+    Obj::ResetCounters();
+    {
+        SegmentedVector<Obj, BLOCK> v;
+        std::vector<const Obj*> addresses;
+        for (int i = 0; i < SIZE; ++i)
+            addresses.push_back(&v.EmplaceBack(i));
+
+        ASSERT_EQ(v.Size(), SIZE);
+        ASSERT_EQ(v.Capacity() % BLOCK, 0);
+        ASSERT_EQ(Obj::num_moved, 0);
+        ASSERT_EQ(Obj::num_copied, 0);
+        for (int i = 0; i < SIZE; ++i) {
+            ASSERT_EQ(&v[i], addresses[i]);
+            ASSERT_EQ(v[i].id, i);
+        }
+
+        v.PushBack(v[0]);
+        ASSERT_EQ(v[SIZE].id, 0);
+
+        v.PopBack();
+        v.Resize(SIZE/2);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), SIZE/2);
+        v.Resize(SIZE);
+        ASSERT_EQ(v[SIZE - 1].id, 0);
+        ASSERT_EQ(&v[SIZE/2 - 1], addresses[SIZE/2 - 1]);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+
+    {
+        // Adding blocks reallocates the block table, not the iterators' handle
+        SegmentedVector<int, BLOCK> v;
+        v.PushBack(0);
+        const auto first = v.begin();
+        const auto cfirst = v.cbegin();
+        for (int i = 1; i < SIZE; ++i)
+            v.PushBack(i);
+
+        ASSERT_GT(v.Capacity(), BLOCK*BLOCK);
+        ASSERT_EQ(&*first, &v[0]);
+        ASSERT_EQ(&*cfirst, &v[0]);
+        ASSERT_EQ(first[SIZE - 1], SIZE - 1);
+        ASSERT_EQ(first + SIZE, v.end());
+    }
+}
+
+TEST(SegmentedVector, CopyAndMove) {
+    using namespace cstl;
+
+    const int SIZE = 100;
+
+    SegmentedVector<std::string, 8> v;
+    for (int i = 0; i < SIZE; ++i)
+        v.PushBack(std::to_string(i));
+
+    SegmentedVector<std::string, 8> v_copy(v);
+    ASSERT_EQ(v_copy.Size(), SIZE);
+    ASSERT_NE(&v_copy[0], &v[0]);
+    ASSERT_EQ(v_copy[SIZE - 1], std::to_string(SIZE - 1));
+
+    const std::string* first = &v[0];
+    SegmentedVector<std::string, 8> v_moved(std::move(v));
+    ASSERT_EQ(&v_moved[0], first);
+    ASSERT_EQ(v.Size(), 0);
+
+    v = v_moved;
+    ASSERT_EQ(v.Size(), SIZE);
+    v_copy.Clear();
+    v_copy = std::move(v_moved);
+    ASSERT_EQ(&v_copy[0], first);
+
+    // Allocators that do not propagate stay with their vector; moving
+    // between unequal ones moves the elements
+    std::pmr::unsynchronized_pool_resource resource, other_resource;
+    using PmrVector = SegmentedVector<int, 8, std::pmr::polymorphic_allocator<int>>;
+    PmrVector a(SIZE, &resource);
+    PmrVector b(&resource);
+    PmrVector c(&other_resource);
+    std::iota(a.begin(), a.end(), 0);
+
+    a.Swap(b);
+    ASSERT_EQ(b.Size(), SIZE);
+    c = b;
+    ASSERT_EQ(c.GetAllocator().resource(), &other_resource);
+    ASSERT_EQ(c[SIZE - 1], SIZE - 1);
+    a = std::move(c);
+    ASSERT_EQ(a.GetAllocator().resource(), &resource);
+    ASSERT_EQ(a.Size(), SIZE);
+    ASSERT_EQ(a[SIZE - 1], SIZE - 1);
+
+    // A copy failing partway through destroys what it built
+    Obj::ResetCounters();
+    {
+        using ObjVector = SegmentedVector<Obj, 8>;
+        ObjVector objs;
+        for (int i = 0; i < SIZE; ++i)
+            objs.EmplaceBack(i);
+
+        Obj::throw_on_copy_id = SIZE/2;
+        ASSERT_THROW(ObjVector partial(objs), std::runtime_error);
+        Obj::throw_on_copy_id = -1;
+        ASSERT_EQ(Obj::GetAliveObjectCount(), SIZE);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+}
+
+TEST(SegmentedVector, MoveAssignmentDestroysOldElements) {
+    using namespace cstl;
+
+    Obj::ResetCounters();
+    {
+        SegmentedVector<Obj, 4> lhs;
+        SegmentedVector<Obj, 4> rhs;
+        for (int i = 0; i < 10; ++i)
+            lhs.EmplaceBack(i);
+        for (int i = 0; i < 3; ++i)
+            rhs.EmplaceBack(i);
+
+        // std::allocator propagates: rhs's blocks are taken over and rhs is
+        // left empty rather than holding lhs's old elements
+        const Obj* first = &rhs[0];
+        lhs = std::move(rhs);
+        ASSERT_EQ(&lhs[0], first);
+        ASSERT_EQ(lhs.Size(), 3);
+        ASSERT_EQ(rhs.Size(), 0);
+        ASSERT_EQ(rhs.Capacity(), 0);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 3);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+}
+
+TEST(SegmentedVector, AllocatorConstructsElements) {
+    using namespace cstl;
+    // Longer than any small-string buffer
+    const std::string_view text = "a string too long to be stored inline in the object";
+
+    CountingResource resource;
+    {
+        SegmentedVector<std::pmr::string, 4, std::pmr::polymorphic_allocator<std::pmr::string>>
+            v(&resource);
+        for (int i = 0; i < 10; ++i)
+            v.EmplaceBack(text);
+        ASSERT_TRUE(std::all_of(v.begin(), v.end(), [&](const std::pmr::string& s) {
+            return s.get_allocator().resource() == &resource;
+        }));
+        const size_t bytes_in_use = resource.bytes_in_use;
+        v.Resize(2);
+        ASSERT_LT(resource.bytes_in_use, bytes_in_use);
+    }
+    ASSERT_EQ(resource.bytes_in_use, 0);
+}
+
+TEST(SegmentedVector, Algorithms) {
+    using namespace cstl;
+
+    const int SIZE = 1000;
+
+    SegmentedVector<int, 32> v(SIZE);
+    const auto& cv = v;
+    std::iota(v.begin(), v.end(), 0);
+    std::reverse(v.begin(), v.end());
+    ASSERT_EQ(v[0], SIZE - 1);
+
+    std::sort(v.begin(), v.end());
+    ASSERT_TRUE(std::is_sorted(cv.begin(), cv.end()));
+    ASSERT_EQ(cv.end() - cv.begin(), SIZE);
+
+    auto it = std::lower_bound(cv.begin(), cv.end(), 500);
+    ASSERT_EQ(*it, 500);
+    ASSERT_EQ(it - cv.begin(), 500);
+    ASSERT_EQ(it[10], 510);
+    ASSERT_TRUE(v.begin() < it);
+    ASSERT_TRUE(it == v.begin() + 500);
+
+    ASSERT_EQ(std::accumulate(cv.cbegin(), cv.cend(), 0), SIZE*(SIZE - 1)/2);
+    ASSERT_EQ(std::find(v.begin(), v.end(), 42) - v.begin(), 42);
+    ASSERT_EQ(std::count_if(cv.begin(), cv.end(), [](int x) { return x % 2; }), SIZE/2);
+    static_assert(std::random_access_iterator<SegmentedVector<int>::iterator>);
+    static_assert(std::random_access_iterator<SegmentedVector<int>::const_iterator>);
+}
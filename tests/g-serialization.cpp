@@ -0,0 +1,181 @@
+#include "serialization/serialization.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+struct Point {
+    int32_t x;
+    int32_t y;
+};
+
+// File in the test temp directory, closed and removed on scope exit
+struct TempFile {
+    explicit TempFile(const std::string& name)
+        : path(std::filesystem::path(testing::TempDir()) / name)
+        , fd(::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644))
+    {
+    }
+
+    ~TempFile() {
+        ::close(fd);
+        std::filesystem::remove(path);
+    }
+
+    void Rewind() const {
+        ::lseek(fd, 0, SEEK_SET);
+    }
+
+    std::filesystem::path path;
+    int fd;
+};
+
+} // namespace
+
+TEST(Serialization, Vector) {
+    using namespace cstl;
+    const TempFile file("serialization_vector.bin");
+    const size_t SIZE = 100'000;
+
+    Vector<uint32_t> v(SIZE);
+    std::iota(v.begin(), v.end(), 7u);
+    WriteBinary(file.fd, v);
+    ASSERT_EQ(std::filesystem::file_size(file.path),
+              sizeof(BinaryHeader) + SIZE*sizeof(uint32_t));
+
+    file.Rewind();
+    const Vector<uint32_t> read = ReadVector<uint32_t>(file.fd);
+    ASSERT_EQ(read.Size(), SIZE);
+    ASSERT_TRUE(std::equal(read.begin(), read.end(), v.begin()));
+
+    // Vector and SimpleVector share the array layout
+    file.Rewind();
+    const SimpleVector<uint32_t> simple = ReadSimpleVector<uint32_t>(file.fd);
+    ASSERT_EQ(simple.GetSize(), SIZE);
+    ASSERT_EQ(simple[SIZE - 1], SIZE + 6);
+}
+
+TEST(Serialization, SimpleVector) {
+    using namespace cstl;
+    const TempFile file("serialization_simple_vector.bin");
+
+    const SimpleVector<Point> v{{1, 2}, {3, 4}, {5, 6}};
+    WriteBinary(file.fd, v);
+
+    file.Rewind();
+    const Vector<Point> read = ReadVector<Point>(file.fd);
+    ASSERT_EQ(read.Size(), 3);
+    ASSERT_EQ(read[2].x, 5);
+    ASSERT_EQ(read[2].y, 6);
+}
+
+TEST(Serialization, Matrix) {
+    using namespace cstl;
+    const TempFile file("serialization_matrix.bin");
+
+    Matrix<double> m(3, 4);
+    std::iota(m.GetData(), m.GetData() + 12, 0.5);
+    WriteBinary(file.fd, m);
+
+    file.Rewind();
+    Matrix<double> read = ReadMatrix<double>(file.fd);
+    ASSERT_EQ(read.GetShape().rows, 3);
+    ASSERT_EQ(read.GetShape().cols, 4);
+    ASSERT_EQ(read[2][3], 11.5);
+
+    file.Rewind();
+    ASSERT_THROW(ReadVector<double>(file.fd), std::runtime_error);
+}
+
+TEST(Serialization, EmptyAndMismatch) {
+    using namespace cstl;
+    const TempFile file("serialization_empty.bin");
+
+    WriteBinary(file.fd, Vector<int>());
+    file.Rewind();
+    ASSERT_EQ(ReadVector<int>(file.fd).Size(), 0);
+
+    file.Rewind();
+    ASSERT_THROW(ReadVector<unsigned>(file.fd), std::runtime_error);
+    file.Rewind();
+    ASSERT_THROW(ReadVector<int64_t>(file.fd), std::runtime_error);
+    // Past the end
+    ASSERT_THROW(ReadVector<int>(file.fd), std::runtime_error);
+}
+
+TEST(Serialization, CorruptHeader) {
+    using namespace cstl;
+    const TempFile file("serialization_corrupt.bin");
+
+    Matrix<int> m(2, 3);
+    WriteBinary(file.fd, m);
+    BinaryHeader header;
+    file.Rewind();
+    ASSERT_EQ(::read(file.fd, &header, sizeof(header)), sizeof(header));
+
+    // rows*cols wraps to 0
+    BinaryHeader wrapped = header;
+    wrapped.rows = wrapped.cols = uint64_t{1} << 32;
+    wrapped.count = 0;
+    const std::span<const std::byte> buffer(reinterpret_cast<const std::byte*>(&wrapped),
+                                            sizeof(wrapped));
+    ASSERT_THROW(ViewBinary<int>(buffer), std::runtime_error);
+    ::pwrite(file.fd, &wrapped, sizeof(wrapped), 0);
+    file.Rewind();
+    ASSERT_THROW(ReadMatrix<int>(file.fd), std::runtime_error);
+
+    // count*sizeof(T) wraps
+    BinaryHeader huge = header;
+    huge.rows = 1;
+    huge.cols = huge.count = uint64_t{1} << 62;
+    ::pwrite(file.fd, &huge, sizeof(huge), 0);
+    file.Rewind();
+    ASSERT_THROW(ReadMatrix<int>(file.fd), std::runtime_error);
+
+    // More elements than the file holds
+    BinaryHeader longer = header;
+    longer.rows = 1;
+    longer.cols = longer.count = 1'000'000;
+    ::pwrite(file.fd, &longer, sizeof(longer), 0);
+    file.Rewind();
+    ASSERT_THROW(ReadMatrix<int>(file.fd), std::runtime_error);
+}
+
+TEST(Serialization, MappedView) {
+    using namespace cstl;
+    const TempFile file("serialization_view.bin");
+
+    Matrix<int> m(2, 3);
+    std::iota(m.GetData(), m.GetData() + 6, 1);
+    WriteBinary(file.fd, m);
+
+    const size_t bytes = std::filesystem::file_size(file.path);
+    void* mapping = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, file.fd, 0);
+    ASSERT_NE(mapping, MAP_FAILED);
+
+    const std::span<const std::byte> buffer(static_cast<const std::byte*>(mapping), bytes);
+    const BinaryView<int> view = ViewBinary<int>(buffer);
+    ASSERT_EQ(view.container, BinaryContainer::Matrix);
+    ASSERT_EQ(view.shape.rows, 2);
+    ASSERT_EQ(view.shape.cols, 3);
+    ASSERT_EQ(view.elements.size(), 6);
+    ASSERT_EQ(view.elements[5], 6);
+    ASSERT_EQ(static_cast<const void*>(view.elements.data()),
+              static_cast<const std::byte*>(mapping) + sizeof(BinaryHeader));
+
+    ASSERT_THROW(ViewBinary<int>(buffer.first(bytes - 1)), std::runtime_error);
+    ASSERT_THROW(ViewBinary<float>(buffer), std::runtime_error);
+
+    ::munmap(mapping, bytes);
+}
@@ -58,6 +58,10 @@ TEST(SimpleVector, InitialisingSetSize) {
     ASSERT_TRUE(!v.IsEmpty());
     for (size_t i = 0; i < v.GetSize(); ++i)
         ASSERT_EQ(v[i], 0);
+
+    SimpleVector<int> unwritten(5, default_init);
+    ASSERT_EQ(unwritten.GetSize(), 5u);
+    ASSERT_EQ(unwritten.GetCapacity(), 5u);
 }
 
 // Инициализация вектора, заполненного заданным значением
@@ -239,6 +243,26 @@ TEST(SimpleVector, Insert) {
     ASSERT_EQ(v, (SimpleVector<int>{1, 2, 42, 3, 4}));
 }
 
+// Вставка в пределах вместимости не переносит элементы
+TEST(SimpleVector, InsertWithinCapacity) {
+    SimpleVector<int> v{1, 2, 3, 4};
+    v.Insert(v.begin(), 0);
+    ASSERT_GT(v.GetCapacity(), v.GetSize());
+
+    const int* data = &v[0];
+    const size_t capacity = v.GetCapacity();
+    v.Insert(v.begin() + 2, 42);
+    ASSERT_EQ(&v[0], data);
+    ASSERT_EQ(v, (SimpleVector<int>{0, 1, 42, 2, 3, 4}));
+
+    // The whole buffer up to the capacity is still usable
+    v.Resize(capacity - 1);
+    ASSERT_EQ(&v[0], data);
+    ASSERT_EQ(v.GetCapacity(), capacity);
+    ASSERT_EQ(v[5], 4);
+    ASSERT_EQ(v[capacity - 2], 0);
+}
+
 // Удаление элементов
 TEST(SimpleVector, Erase) {
     SimpleVector<int> v{1, 2, 3, 4};
@@ -0,0 +1,190 @@
+#include "small_vector/small_vector.h"
+
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+#include "counting_fixtures.h"
+
+TEST(SmallVector, InlineStorage) {
+    using namespace cstl;
+
+    const size_t N = 8;
+
+    CountingResource resource;
+    SmallVector<int, N, std::pmr::polymorphic_allocator<int>> v(&resource);
+    ASSERT_EQ(v.Size(), 0);
+    ASSERT_EQ(v.Capacity(), N);
+    ASSERT_TRUE(v.IsInline());
+
+    for (size_t i = 0; i < N; ++i)
+        v.PushBack(static_cast<int>(i));
+    ASSERT_TRUE(v.IsInline());
+    ASSERT_EQ(resource.num_allocations, 0);
+
+    const auto* self = reinterpret_cast<const std::byte*>(&v);
+    const auto* first = reinterpret_cast<const std::byte*>(&v[0]);
+    ASSERT_GE(first, self);
+    ASSERT_LT(first, self + sizeof(v));
+
+    v.PushBack(static_cast<int>(N));
+    ASSERT_FALSE(v.IsInline());
+    ASSERT_EQ(v.Capacity(), N*2);
+    ASSERT_EQ(resource.num_allocations, 1);
+    for (size_t i = 0; i <= N; ++i)
+        ASSERT_EQ(v[i], static_cast<int>(i));
+}
+
+TEST(SmallVector, Modifiers) {
+    using namespace cstl;
+
+    const int N = 4;
+    const int ID = 42;
+
+    Obj::ResetCounters();
+    {
+        SmallVector<Obj, N> v;
+        for (int i = 0; i < N; ++i)
+            v.EmplaceBack(i);
+        ASSERT_EQ(Obj::num_moved, 0);
+
+        auto pos = v.Emplace(v.cbegin() + 1, ID);
+        ASSERT_EQ(&*pos, &v[1]);
+        ASSERT_EQ(v.Size(), N + 1);
+        ASSERT_EQ(v.Capacity(), N*2);
+        ASSERT_EQ(Obj::num_moved, N);
+
+        v.Insert(v.cbegin(), v[N]);
+        ASSERT_EQ(v[0].id, N - 1);
+        ASSERT_EQ(v[2].id, ID);
+
+        pos = v.Erase(v.cbegin() + 2);
+        ASSERT_EQ(pos->id, 1);
+        ASSERT_EQ(v.Size(), N + 1);
+
+        v.PopBack();
+        v.Resize(N*4);
+        ASSERT_EQ(v.Size(), N*4);
+        ASSERT_EQ(v[N*4 - 1].id, 0);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), N*4);
+
+        v.Resize(1);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 1);
+        ASSERT_EQ(v[0].id, N - 1);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+
+    {
+        SmallVector<std::unique_ptr<int>, N> v;
+        for (int i = 0; i < N*3; ++i)
+            v.Insert(v.cbegin(), std::make_unique<int>(i));
+        v.Erase(v.cbegin());
+        ASSERT_EQ(v.Size(), N*3 - 1);
+        ASSERT_EQ(*v[0], N*3 - 2);
+        ASSERT_EQ(*v[N*3 - 2], 0);
+    }
+}
+
+TEST(SmallVector, CopyAndMove) {
+    using namespace cstl;
+
+    const int N = 4;
+
+    Obj::ResetCounters();
+    {
+        SmallVector<Obj, N> inline_v;
+        SmallVector<Obj, N> heap_v;
+        for (int i = 0; i < N; ++i)
+            inline_v.EmplaceBack(i);
+        for (int i = 0; i < N*2; ++i)
+            heap_v.EmplaceBack(i);
+
+        SmallVector<Obj, N> copy(heap_v);
+        ASSERT_EQ(copy.Size(), N*2);
+        ASSERT_EQ(copy[N*2 - 1].id, N*2 - 1);
+
+        const int num_moved = Obj::num_moved;
+        const Obj* heap_data = &heap_v[0];
+        SmallVector<Obj, N> moved(std::move(heap_v));
+        ASSERT_EQ(&moved[0], heap_data);
+        ASSERT_EQ(heap_v.Size(), 0);
+        ASSERT_EQ(Obj::num_moved, num_moved);
+
+        SmallVector<Obj, N> moved_inline(std::move(inline_v));
+        ASSERT_EQ(moved_inline.Size(), N);
+        ASSERT_TRUE(moved_inline.IsInline());
+        ASSERT_EQ(Obj::num_moved, num_moved + N);
+
+        moved.Swap(moved_inline);
+        ASSERT_EQ(moved.Size(), N);
+        ASSERT_EQ(moved_inline.Size(), N*2);
+        ASSERT_EQ(&moved_inline[0], heap_data);
+
+        copy = moved;
+        ASSERT_EQ(copy.Size(), N);
+        ASSERT_EQ(copy[N - 1].id, N - 1);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+
+    // Moving between unequal allocators may allocate
+    static_assert(std::is_nothrow_move_assignable_v<SmallVector<Obj, N>>);
+    static_assert(!std::is_nothrow_move_assignable_v<
+                  SmallVector<int, N, std::pmr::polymorphic_allocator<int>>>);
+}
+
+TEST(SmallVector, AllocatorConstructsElements) {
+    using namespace cstl;
+    using PmrVector = SmallVector<std::pmr::string, 2,
+                                  std::pmr::polymorphic_allocator<std::pmr::string>>;
+    // Longer than any small-string buffer
+    const std::string_view text = "a string too long to be stored inline in the object";
+    CountingResource lhs_resource;
+    CountingResource rhs_resource;
+
+    const auto uses = [](const PmrVector& v, const std::pmr::memory_resource* resource) {
+        return v.GetAllocator().resource() == resource
+               && std::all_of(v.begin(), v.end(), [&](const std::pmr::string& s) {
+                      return s.get_allocator().resource() == resource;
+                  });
+    };
+
+    PmrVector lhs(&lhs_resource);
+    PmrVector rhs(&rhs_resource);
+    lhs.EmplaceBack(text);
+    for (int i = 0; i < 5; ++i)
+        rhs.Emplace(rhs.cbegin(), text);
+    rhs.Resize(7);
+    ASSERT_TRUE(uses(lhs, &lhs_resource));
+    ASSERT_TRUE(uses(rhs, &rhs_resource));
+
+    // Allocators that do not propagate stay put
+    lhs = rhs;
+    ASSERT_EQ(lhs.Size(), 7);
+    ASSERT_EQ(lhs[4], text);
+    ASSERT_TRUE(uses(lhs, &lhs_resource));
+
+    lhs = std::move(rhs);
+    ASSERT_EQ(lhs[0], text);
+    ASSERT_TRUE(uses(lhs, &lhs_resource));
+
+    lhs.Clear();
+    rhs.Clear();
+    ASSERT_EQ(lhs_resource.bytes_in_use, lhs.Capacity()*sizeof(std::pmr::string));
+    ASSERT_EQ(rhs_resource.bytes_in_use, rhs.Capacity()*sizeof(std::pmr::string));
+}
+
+TEST(SmallVector, Algorithms) {
+    using namespace cstl;
+
+    SmallVector<int, 16> v(10);
+    std::iota(v.begin(), v.end(), 0);
+    std::reverse(v.begin(), v.end());
+    ASSERT_TRUE(std::is_sorted(v.cbegin(), v.cend(), std::greater<>()));
+    ASSERT_EQ(std::accumulate(v.cbegin(), v.cend(), 0), 45);
+}
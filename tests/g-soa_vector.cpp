@@ -0,0 +1,134 @@
+#include "soa_vector/soa_vector.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "counting_fixtures.h"
+
+TEST(SoAVector, PushBackAndColumns) {
+    using namespace cstl;
+
+    const int SIZE = 1000;
+
+    SoAVector<int, double, char> v;
+    for (int i = 0; i < SIZE; ++i)
+        v.PushBack({i, i*0.5, static_cast<char>('a' + i % 26)});
+
+    ASSERT_EQ(v.Size(), SIZE);
+    ASSERT_GE(v.Capacity(), SIZE);
+
+    const std::span<const double> prices = std::as_const(v).Column<1>();
+    ASSERT_EQ(prices.size(), SIZE);
+    ASSERT_EQ(std::accumulate(prices.begin(), prices.end(), 0.0),
+              0.5*SIZE*(SIZE - 1)/2);
+
+    for (int& id : v.Column<0>())
+        id *= 2;
+    ASSERT_EQ(v[10].Get<0>(), 20);
+    ASSERT_EQ(get<2>(v[27]), 'b');
+
+    auto [id, price, tag] = v[3];
+    price = 42.0;
+    ASSERT_EQ(id, 6);
+    ASSERT_EQ(tag, 'd');
+    ASSERT_EQ(v.Column<1>()[3], 42.0);
+
+    const std::tuple<int, double, char> record = v[4];
+    ASSERT_EQ(record, std::make_tuple(8, 2.0, 'e'));
+    ASSERT_TRUE(v[4] == record);
+}
+
+TEST(SoAVector, EmplaceBack) {
+    using namespace cstl;
+
+    SoAVector<std::string, int> v;
+    auto ref = v.EmplaceBack("xxx", 'x');
+    ASSERT_EQ(ref.Get<0>(), "xxx");
+    ASSERT_EQ(ref.Get<1>(), int('x'));
+
+    // Arguments referring into the vector survive reallocation
+    for (int i = 0; i < 100; ++i)
+        v.EmplaceBack(v[0].Get<0>(), i);
+    ASSERT_EQ(v.Size(), 101);
+    ASSERT_EQ(v[100].Get<0>(), "xxx");
+
+    v.PopBack();
+    v.Resize(3);
+    ASSERT_EQ(v.Size(), 3);
+    v.Resize(5);
+    ASSERT_EQ(v[4].Get<0>(), "");
+    ASSERT_EQ(v[4].Get<1>(), 0);
+}
+
+TEST(SoAVector, StlAlgorithms) {
+    using namespace cstl;
+
+    SoAVector<int, std::string> v;
+    for (int i : {5, 3, 9, 1, 7})
+        v.PushBack({i, std::to_string(i)});
+
+    std::sort(v.begin(), v.end(), [](const auto& lhs, const auto& rhs) {
+        return get<0>(lhs) < get<0>(rhs);
+    });
+    for (size_t i = 0; i + 1 < v.Size(); ++i)
+        ASSERT_LT(v[i].Get<0>(), v[i + 1].Get<0>());
+    for (auto [id, name] : v)
+        ASSERT_EQ(std::to_string(id), name);
+
+    const auto it = std::find_if(v.cbegin(), v.cend(), [](const auto& record) {
+        return get<1>(record) == "7";
+    });
+    ASSERT_EQ(it - v.cbegin(), 3);
+    ASSERT_EQ(std::count_if(v.begin(), v.end(), [](const auto& record) {
+        return get<0>(record) > 4;
+    }), 3);
+
+    std::reverse(v.begin(), v.end());
+    ASSERT_EQ(v[0].Get<1>(), "9");
+    ASSERT_EQ(v.end() - v.begin(), 5);
+}
+
+TEST(SoAVector, CopyMoveAndLifetime) {
+    using namespace cstl;
+
+    const int SIZE = 50;
+
+    Obj::ResetCounters();
+    {
+        SoAVector<Obj, int> v;
+        for (int i = 0; i < SIZE; ++i)
+            v.EmplaceBack(i, i);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), SIZE);
+
+        SoAVector<Obj, int> copy(v);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 2*SIZE);
+        ASSERT_EQ(copy[SIZE - 1].Get<0>().id, SIZE - 1);
+
+        SoAVector<Obj, int> moved(std::move(copy));
+        ASSERT_EQ(copy.Size(), 0);
+        ASSERT_EQ(moved.Size(), SIZE);
+
+        v = moved;
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 2*SIZE);
+
+        // A throwing field leaves no partial record behind
+        Obj::throw_on_copy_id = 7;
+        const Obj bad(7);
+        ASSERT_THROW(v.EmplaceBack(bad, 0), std::runtime_error);
+        ASSERT_EQ(v.Size(), SIZE);
+
+        // Nor does a copy failing partway through
+        using Records = SoAVector<Obj, int>;
+        ASSERT_THROW(Records partial(v), std::runtime_error);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 2*SIZE + 1);
+        Obj::throw_on_copy_id = Obj::NO_ID;
+
+        v.Clear();
+        ASSERT_EQ(v.Size(), 0);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+}
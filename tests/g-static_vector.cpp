@@ -0,0 +1,148 @@
+#include "static_vector/static_vector.h"
+
+#include <array>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <gtest/gtest.h>
+
+#include "counting_fixtures.h"
+
+namespace {
+
+struct Point {
+    int x, y;
+};
+
+} // namespace
+
+TEST(StaticVector, InlineStorage) {
+    using namespace cstl;
+    StaticVector<int, 8> v;
+    ASSERT_EQ(v.Size(), 0);
+    ASSERT_EQ(v.Capacity(), 8);
+
+    for (int i = 0; i < 8; ++i)
+        v.PushBack(i);
+    ASSERT_TRUE(v.IsFull());
+
+    const auto* self = reinterpret_cast<const std::byte*>(&v);
+    const auto* first = reinterpret_cast<const std::byte*>(&v[0]);
+    ASSERT_GE(first, self);
+    ASSERT_LT(first, self + sizeof(v));
+
+    ASSERT_TRUE(std::equal(v.begin(), v.end(), std::array{0, 1, 2, 3, 4, 5, 6, 7}.begin()));
+}
+
+TEST(StaticVector, FullPolicies) {
+    using namespace cstl;
+    {
+        StaticVector<int, 2> v;
+        v.PushBack(1);
+        v.EmplaceBack(2);
+        ASSERT_THROW(v.PushBack(3), std::length_error);
+        ASSERT_THROW(v.Insert(v.cbegin(), 3), std::length_error);
+        ASSERT_THROW(v.Resize(3), std::length_error);
+        ASSERT_EQ(v.Size(), 2);
+    }
+    {
+        StaticVector<std::string, 2, OnFull::ReturnFalse> v;
+        ASSERT_TRUE(v.PushBack("a"));
+        std::string* b = v.EmplaceBack("b");
+        ASSERT_NE(b, nullptr);
+        ASSERT_EQ(*b, "b");
+
+        ASSERT_FALSE(v.PushBack("c"));
+        ASSERT_EQ(v.EmplaceBack("c"), nullptr);
+        ASSERT_EQ(v.Emplace(v.cbegin(), "c"), v.end());
+        ASSERT_EQ(v.Insert(v.cbegin(), 2, "c"), v.end());
+        ASSERT_FALSE(v.Resize(5));
+        ASSERT_EQ(v.Size(), 2);
+        ASSERT_EQ(v[0], "a");
+    }
+    {
+        StaticVector<int, 1, OnFull::Assert> v;
+        v.PushBack(1);
+        ASSERT_EQ(v[0], 1);
+#if !defined(NDEBUG)
+        ASSERT_DEATH(v.PushBack(2), "capacity exceeded");
+#endif
+    }
+}
+
+TEST(StaticVector, TriviallyCopyable) {
+    using namespace cstl;
+    using Points = StaticVector<Point, 4>;
+    static_assert(std::is_trivially_copyable_v<Points>);
+    static_assert(!std::is_trivially_copyable_v<StaticVector<std::string, 4>>);
+
+    Points v;
+    v.PushBack({1, 2});
+    v.EmplaceBack(3, 4);
+
+    // E.g. through shared memory
+    alignas(Points) std::byte buffer[sizeof(Points)];
+    std::memcpy(buffer, &v, sizeof(v));
+    Points copy;
+    std::memcpy(&copy, buffer, sizeof(copy));
+
+    ASSERT_EQ(copy.Size(), 2);
+    ASSERT_EQ(copy[1].x, 3);
+    ASSERT_EQ(copy[1].y, 4);
+}
+
+TEST(StaticVector, Modifiers) {
+    using namespace cstl;
+    StaticVector<int, 16> v(4);
+    std::iota(v.begin(), v.end(), 0);
+
+    v.Emplace(v.cbegin() + 1, 10);
+    v.Insert(v.cbegin(), 2, v[3]);
+    ASSERT_TRUE(std::equal(v.begin(), v.end(), std::array{2, 2, 0, 10, 1, 2, 3}.begin()));
+
+    ASSERT_EQ(*v.Erase(v.cbegin() + 1), 0);
+    ASSERT_EQ(v.Erase(v.cbegin() + 1, v.cbegin() + 3), v.begin() + 1);
+    ASSERT_TRUE(std::equal(v.begin(), v.end(), std::array{2, 1, 2, 3}.begin()));
+
+    v.Resize(6);
+    ASSERT_EQ(v[5], 0);
+    v.PopBack();
+    ASSERT_EQ(v.Size(), 5);
+}
+
+TEST(StaticVector, Lifetime) {
+    using namespace cstl;
+    Obj::ResetCounters();
+    {
+        StaticVector<Obj, 8> v;
+        for (int i = 0; i < 4; ++i)
+            v.EmplaceBack(i);
+        v.Emplace(v.cbegin(), v[3]);
+        v.Insert(v.cbegin() + 2, 2, v[0]);
+        ASSERT_EQ(v.Size(), 7);
+        ASSERT_EQ(v[0].id, 3);
+        ASSERT_EQ(v[2].id, 3);
+        ASSERT_EQ(v[4].id, 1);
+
+        StaticVector<Obj, 8> copy(v);
+        StaticVector<Obj, 8> other;
+        other.EmplaceBack(42);
+        other.Swap(copy);
+        ASSERT_EQ(copy.Size(), 1);
+        ASSERT_EQ(copy[0].id, 42);
+        ASSERT_EQ(other.Size(), 7);
+
+        copy = other;
+        ASSERT_EQ(copy.Size(), 7);
+        other = std::move(copy);
+        ASSERT_EQ(copy.Size(), 0);
+
+        v.Erase(v.cbegin(), v.cbegin() + 5);
+        ASSERT_EQ(v.Size(), 2);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 2 + 7);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+}
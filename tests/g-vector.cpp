@@ -1,4 +1,14 @@
 #include "vector/vector.h"
+#include "vector/aligned_allocator.h"
+#include "vector/mmap_allocator.h"
+
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -113,8 +123,88 @@ struct Obj {
     static inline int num_move_assigned = 0;
 };
 
+// Counts special member calls like Obj, but opts in to bytewise relocation
+struct RelocatableObj {
+    explicit RelocatableObj(int id) : id(id) {}
+
+    RelocatableObj(const RelocatableObj& other) : id(other.id) {
+        ++num_copied;
+    }
+
+    RelocatableObj(RelocatableObj&& other) noexcept : id(other.id) {
+        ++num_moved;
+    }
+
+    RelocatableObj& operator=(const RelocatableObj&) = default;
+
+    RelocatableObj& operator=(RelocatableObj&&) = default;
+
+    ~RelocatableObj() {
+        ++num_destroyed;
+    }
+
+    static void ResetCounters() {
+        num_copied = 0;
+        num_moved = 0;
+        num_destroyed = 0;
+    }
+
+    int id = 0;
+
+    static inline int num_copied = 0;
+    static inline int num_moved = 0;
+    static inline int num_destroyed = 0;
+};
+
+// Allocator tagged with an arena id that counts its live allocations
+template <typename T, bool Propagate>
+struct ArenaAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_move_assignment = std::bool_constant<Propagate>;
+    using propagate_on_container_swap = std::bool_constant<Propagate>;
+
+    ArenaAllocator() = default;
+
+    explicit ArenaAllocator(int id) : id(id) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U, Propagate>& other) : id(other.id) {}
+
+    T* allocate(size_t n) {
+        ++num_allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        --num_allocations;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    bool operator==(const ArenaAllocator& rhs) const {
+        return id == rhs.id;
+    }
+
+    int id = 0;
+
+    static inline int num_allocations = 0;
+};
+
+// Grows by a fixed step and counts how often it was asked to
+struct StepGrowth {
+    size_t NextCapacity(size_t capacity, size_t required, size_t) {
+        ++num_calls;
+        return std::max(capacity + 10, required);
+    }
+
+    int num_calls = 0;
+};
+
 }  // namespace
 
+template <>
+struct cstl::is_trivially_relocatable<RelocatableObj> : std::true_type {};
+
 TEST(Vector, Reserve) {
     using namespace cstl;
 
@@ -481,6 +571,16 @@ TEST(Vector, Insert) {
             return obj.IsAlive();
         }));
     }
+    {
+        // A throwing copy propagates out of Insert
+        Obj::ResetCounters();
+        Vector<Obj> v{SIZE};
+        Obj obj{1};
+        obj.throw_on_copy = true;
+        ASSERT_THROW(v.Insert(v.cbegin() + 1, obj), std::runtime_error);
+        ASSERT_THROW(v.Insert(v.cend(), obj), std::runtime_error);
+        ASSERT_EQ(v.Size(), SIZE);
+    }
 }
 
 TEST(Vector, Erase) {
@@ -615,6 +715,749 @@ TEST(Vector, Emplace) {
     }
 }
 
+TEST(Vector, TriviallyRelocatable) {
+    using namespace cstl;
+
+    static_assert(is_trivially_relocatable_v<int>);
+    static_assert(is_trivially_relocatable_v<std::unique_ptr<int>>);
+    static_assert(is_trivially_relocatable_v<RelocatableObj>);
+    static_assert(!is_trivially_relocatable_v<Obj>);
+
+    const int SIZE = 100;
+
+    {
+        RelocatableObj::ResetCounters();
+        Vector<RelocatableObj> v;
+        for (int i = 0; i < SIZE; ++i)
+            v.EmplaceBack(i);
+        v.Reserve(SIZE*4);
+        ASSERT_EQ(RelocatableObj::num_moved, 0);
+        ASSERT_EQ(RelocatableObj::num_copied, 0);
+        ASSERT_EQ(RelocatableObj::num_destroyed, 0);
+
+        v.Emplace(v.cbegin() + SIZE/2, -1);
+        v.Erase(v.cbegin());
+        ASSERT_EQ(RelocatableObj::num_moved, 0);
+        ASSERT_EQ(RelocatableObj::num_destroyed, 1);
+        ASSERT_EQ(v.Size(), SIZE);
+        ASSERT_EQ(v[0].id, 1);
+        ASSERT_EQ(v[SIZE/2 - 1].id, -1);
+        ASSERT_EQ(v[SIZE - 1].id, SIZE - 1);
+    }
+    ASSERT_EQ(RelocatableObj::num_destroyed, SIZE + 1);
+
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < SIZE; ++i)
+            v.PushBack(std::make_unique<int>(i));
+        v.Insert(v.cbegin(), std::make_unique<int>(-1));
+        v.Emplace(v.cbegin() + 2, std::make_unique<int>(-2));
+        v.Erase(v.cbegin() + 1);
+
+        ASSERT_EQ(v.Size(), SIZE + 1);
+        ASSERT_EQ(*v[0], -1);
+        ASSERT_EQ(*v[1], -2);
+        for (int i = 1; i < SIZE; ++i)
+            ASSERT_EQ(*v[i + 1], i);
+    }
+    {
+        Vector<int> v(3);
+        v[0] = 7;
+        v.Insert(v.cbegin() + 1, v[0]);
+        v.Insert(v.cbegin(), v[3]);
+        ASSERT_EQ(v.Size(), 5);
+        ASSERT_EQ(v[0], 0);
+        ASSERT_EQ(v[1], 7);
+        ASSERT_EQ(v[2], 7);
+    }
+}
+
+TEST(Vector, Allocator) {
+    using namespace cstl;
+
+    const size_t SIZE = 100;
+    const int ID = 42;
+
+    {
+        std::byte buffer[4096];
+        std::pmr::monotonic_buffer_resource arena(
+            buffer, sizeof(buffer),
+            std::pmr::null_memory_resource()
+        );
+
+        pmr::Vector<int> v(&arena);
+        for (size_t i = 0; i < SIZE; ++i)
+            v.PushBack(ID);
+        ASSERT_EQ(v.GetAllocator().resource(), &arena);
+        ASSERT_GE(reinterpret_cast<std::byte*>(&v[0]), buffer);
+        ASSERT_LT(reinterpret_cast<std::byte*>(&v[0]), buffer + sizeof(buffer));
+
+        pmr::Vector<int> v_copy(v);
+        ASSERT_EQ(v_copy.GetAllocator().resource(), std::pmr::get_default_resource());
+        ASSERT_EQ(v_copy[SIZE - 1], ID);
+
+        v_copy = v;
+        ASSERT_EQ(v_copy.GetAllocator().resource(), std::pmr::get_default_resource());
+
+        pmr::Vector<int> v_moved(&arena);
+        v_moved = std::move(v_copy);
+        ASSERT_EQ(v_moved.GetAllocator().resource(), &arena);
+        ASSERT_EQ(v_moved.Size(), SIZE);
+    }
+
+    using Propagating = ArenaAllocator<Obj, true>;
+    using Sticky = ArenaAllocator<Obj, false>;
+
+    Obj::ResetCounters();
+    {
+        Vector<Obj, Propagating> lhs(SIZE, Propagating{1});
+        Vector<Obj, Propagating> rhs(SIZE/2, Propagating{2});
+        lhs = rhs;
+        ASSERT_EQ(lhs.GetAllocator().id, 2);
+        ASSERT_EQ(lhs.Size(), SIZE/2);
+
+        Vector<Obj, Propagating> moved(Propagating{3});
+        moved = std::move(lhs);
+        ASSERT_EQ(moved.GetAllocator().id, 2);
+        ASSERT_EQ(Obj::num_moved, 0);
+
+        moved.Swap(rhs);
+        ASSERT_EQ(Propagating::num_allocations, 2);
+    }
+    ASSERT_EQ(Propagating::num_allocations, 0);
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+
+    Obj::ResetCounters();
+    {
+        Vector<Obj, Sticky> lhs(Sticky{1});
+        Vector<Obj, Sticky> rhs(SIZE, Sticky{2});
+        rhs[0].id = ID;
+
+        lhs = std::move(rhs);
+        ASSERT_EQ(lhs.GetAllocator().id, 1);
+        ASSERT_EQ(lhs.Size(), SIZE);
+        ASSERT_EQ(lhs[0].id, ID);
+        ASSERT_EQ(Obj::num_moved, SIZE);
+
+        Vector<Obj, Sticky> moved(std::move(lhs), Sticky{1});
+        ASSERT_EQ(Obj::num_moved, SIZE);
+        ASSERT_EQ(moved.Size(), SIZE);
+    }
+    ASSERT_EQ(Sticky::num_allocations, 0);
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+}
+
+TEST(Vector, AllocatorConstructsElements) {
+    using namespace cstl;
+
+    const size_t SIZE = 50;
+    // Longer than any small-string buffer
+    const char* const TEXT = "a string too long to be stored inline in the object";
+
+    std::byte buffer[1 << 16];
+    std::pmr::monotonic_buffer_resource arena(
+        buffer, sizeof(buffer),
+        std::pmr::null_memory_resource()
+    );
+    // Anything allocated from the default resource instead of the arena throws
+    std::pmr::memory_resource* old_default
+        = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+    const auto in_arena = [&](const std::pmr::string& s) {
+        const auto* p = reinterpret_cast<const std::byte*>(s.data());
+        return s.get_allocator().resource() == &arena
+               && p >= buffer && p < buffer + sizeof(buffer);
+    };
+
+    {
+        pmr::Vector<std::pmr::string> v(&arena);
+        for (size_t i = 0; i < SIZE; ++i)
+            v.EmplaceBack(TEXT);
+        v.Emplace(v.cbegin() + 1, TEXT);
+        v.Insert(v.cbegin() + 2, 3, v[0]);
+        v.Resize(v.Size() + 2);
+        const std::array<const char*, 2> more{TEXT, TEXT};
+        v.Insert(v.cbegin(), more.begin(), more.end());
+
+        pmr::Vector<std::pmr::string> other(&arena);
+        other.Assign(v);
+        other.Erase(other.cbegin());
+
+        ASSERT_EQ(v.Size(), SIZE + 1 + 3 + 2 + 2);
+        ASSERT_EQ(v[0], TEXT);
+        ASSERT_TRUE(v[v.Size() - 1].empty());
+        for (const auto& s : v)
+            ASSERT_EQ(s.get_allocator().resource(), &arena);
+        for (size_t i = 0; i < SIZE; ++i) {
+            ASSERT_TRUE(in_arena(v[i]));
+            ASSERT_TRUE(in_arena(other[i]));
+        }
+    }
+
+    std::pmr::set_default_resource(old_default);
+}
+
+TEST(Vector, GrowthPolicy) {
+    using namespace cstl;
+
+    const size_t SIZE = 1000;
+
+    const auto capacities = [](auto v) {
+        std::vector<size_t> result;
+        for (size_t i = 0; i < SIZE; ++i) {
+            if (v.Size() == v.Capacity())
+                result.push_back(v.Capacity());
+            v.PushBack(0);
+        }
+        return result;
+    };
+
+    {
+        const auto steps = capacities(Vector<int>());
+        ASSERT_EQ(steps.size(), 11);
+        ASSERT_EQ(steps[1], 1);
+        ASSERT_EQ(steps[2], 2);
+        ASSERT_EQ(steps.back(), 512);
+    }
+    {
+        const auto steps = capacities(Vector<int, std::allocator<int>, DoublingGrowth<16>>());
+        ASSERT_EQ(steps.size(), 7);
+        ASSERT_EQ(steps[1], 16);
+    }
+    {
+        const auto steps = capacities(Vector<int, std::allocator<int>, OneAndHalfGrowth<4>>());
+        ASSERT_EQ(steps[1], 4);
+        ASSERT_EQ(steps[2], 6);
+        ASSERT_EQ(steps[3], 9);
+        ASSERT_EQ(steps[4], 13);
+    }
+    {
+        const auto steps = capacities(Vector<int, std::allocator<int>, ExactGrowth<>>());
+        ASSERT_EQ(steps.size(), SIZE);
+    }
+    {
+        Vector<char, std::allocator<char>, SizeClassGrowth<>> v;
+        for (size_t i = 0; i < 200; ++i)
+            v.PushBack('x');
+        ASSERT_EQ(v.Capacity(), 256);
+        v.Reserve(5000);
+        for (size_t i = 200; i < 5001; ++i)
+            v.PushBack('x');
+        ASSERT_EQ(v.Capacity(), 12288);
+
+        static_assert(SizeClassGrowth<>::RoundUp(1) == 16);
+        static_assert(SizeClassGrowth<>::RoundUp(129) == 160);
+        static_assert(SizeClassGrowth<>::RoundUp(300) == 320);
+        static_assert(SizeClassGrowth<>::RoundUp(4097) == 8192);
+    }
+    {
+        Vector<Obj, std::allocator<Obj>, StepGrowth> v;
+        for (size_t i = 0; i < 25; ++i)
+            v.EmplaceBack(static_cast<int>(i));
+        v.Emplace(v.cbegin() + 1, -1);
+        ASSERT_EQ(v.Capacity(), 30);
+        ASSERT_EQ(v[1].id, -1);
+    }
+}
+
+TEST(Vector, InsertRange) {
+    using namespace cstl;
+
+    const size_t SIZE = 10;
+    const int ID = 42;
+
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        std::vector<Obj> source(SIZE*2, Obj{ID});
+        const int num_copied = Obj::num_copied;
+
+        auto pos = v.Insert(v.cbegin() + 2, source.begin(), source.end());
+        ASSERT_EQ(&*pos, &v[2]);
+        ASSERT_EQ(v.Size(), SIZE*3);
+        ASSERT_EQ(v.Capacity(), SIZE*3);
+        ASSERT_EQ(Obj::num_copied - num_copied, SIZE*2);
+        ASSERT_EQ(Obj::num_moved, SIZE);
+        ASSERT_EQ(v[1].id, 0);
+        ASSERT_EQ(v[2].id, ID);
+        ASSERT_EQ(v[SIZE*2 + 1].id, ID);
+        ASSERT_EQ(v[SIZE*2 + 2].id, 0);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+
+    // Without reallocation the tail is shifted once, for both a gap shorter
+    // and longer than the tail
+    for (const size_t count : {SIZE/2, SIZE*2}) {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.Reserve(SIZE*4);
+        for (size_t i = 0; i < SIZE; ++i)
+            v.EmplaceBack(static_cast<int>(i));
+
+        v.Insert(v.cbegin() + 1, count, Obj{ID});
+        ASSERT_EQ(v.Size(), SIZE + count);
+        ASSERT_EQ(v.Capacity(), SIZE*4);
+        ASSERT_EQ(Obj::num_moved + Obj::num_move_assigned, SIZE - 1);
+        ASSERT_EQ(v[0].id, 0);
+        ASSERT_EQ(v[count].id, ID);
+        ASSERT_EQ(v[count + 1].id, 1);
+        ASSERT_EQ(v[SIZE + count - 1].id, static_cast<int>(SIZE - 1));
+        ASSERT_EQ(Obj::GetAliveObjectCount(), static_cast<int>(SIZE + count));
+    }
+
+    {
+        Vector<int> v(SIZE);
+        std::iota(v.begin(), v.end(), 0);
+        v.Insert(v.cbegin(), 3, v[SIZE - 1]);
+        ASSERT_EQ(v.Size(), SIZE + 3);
+        ASSERT_EQ(v[0], 9);
+        ASSERT_EQ(v[2], 9);
+        ASSERT_EQ(v[3], 0);
+
+        std::istringstream input("1 2 3");
+        v.Insert(
+            v.cbegin() + 1,
+            std::istream_iterator<int>(input),
+            std::istream_iterator<int>()
+        );
+        ASSERT_EQ(v.Size(), SIZE + 6);
+        ASSERT_EQ(v[1], 1);
+        ASSERT_EQ(v[3], 3);
+        ASSERT_EQ(v[4], 9);
+
+        const int tail[] = {-1, -2};
+        v.Append(tail);
+        ASSERT_EQ(v.Size(), SIZE + 8);
+        ASSERT_EQ(v[SIZE + 7], -2);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        v.PushBack(std::make_unique<int>(0));
+        v.PushBack(std::make_unique<int>(3));
+        std::vector<std::unique_ptr<int>> source;
+        source.push_back(std::make_unique<int>(1));
+        source.push_back(std::make_unique<int>(2));
+        v.Insert(
+            v.cbegin() + 1,
+            std::make_move_iterator(source.begin()),
+            std::make_move_iterator(source.end())
+        );
+        ASSERT_EQ(v.Size(), 4);
+        for (int i = 0; i < 4; ++i)
+            ASSERT_EQ(*v[i], i);
+    }
+}
+
+TEST(Vector, Assign) {
+    using namespace cstl;
+
+    const size_t SIZE = 10;
+
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v(SIZE);
+        std::vector<Obj> source(SIZE/2, Obj{1});
+
+        v.Assign(source);
+        ASSERT_EQ(v.Size(), SIZE/2);
+        ASSERT_EQ(v.Capacity(), SIZE);
+        ASSERT_EQ(v[0].id, 1);
+        ASSERT_EQ(Obj::num_assigned, SIZE/2);
+
+        source.resize(SIZE, Obj{2});
+        v.Assign(source);
+        ASSERT_EQ(v.Size(), SIZE);
+        ASSERT_EQ(v.Capacity(), SIZE);
+        ASSERT_EQ(v[SIZE - 1].id, 2);
+
+        source.resize(SIZE*3, Obj{3});
+        v.Assign(source.begin(), source.end());
+        ASSERT_EQ(v.Size(), SIZE*3);
+        ASSERT_EQ(v.Capacity(), SIZE*3);
+        ASSERT_EQ(v[SIZE*3 - 1].id, 3);
+
+        std::istringstream input("4 5");
+        v.Assign(std::istream_iterator<int>(input), std::istream_iterator<int>());
+        ASSERT_EQ(v.Size(), 2);
+        ASSERT_EQ(v[1].id, 5);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+}
+
+TEST(Vector, DefaultInit) {
+    using namespace cstl;
+
+    const size_t SIZE = 100;
+    const unsigned char MAGIC = 0xAB;
+
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE, default_init);
+        ASSERT_EQ(v.Size(), SIZE);
+        ASSERT_EQ(Obj::num_default_constructed, SIZE);
+
+        v.ResizeDefaultInit(SIZE*2);
+        ASSERT_EQ(Obj::num_default_constructed, SIZE*2);
+        v.ResizeDefaultInit(1);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 1);
+    }
+    {
+        Vector<unsigned char> v(SIZE);
+        std::fill(v.begin(), v.end(), MAGIC);
+        v.Resize(0);
+
+        // Memory is left as it was instead of being zeroed
+        v.ResizeUninitialized(SIZE);
+        ASSERT_EQ(v.Capacity(), SIZE);
+        ASSERT_EQ(v[SIZE - 1], MAGIC);
+
+        v.Resize(0);
+        v.Resize(SIZE);
+        ASSERT_EQ(v[SIZE - 1], 0);
+    }
+    {
+        Vector<int> v(SIZE/2);
+        v.ResizeAndOverwrite(SIZE, [](int* tail, size_t n) {
+            std::iota(tail, tail + n - 1, 1);
+            return n - 1;
+        });
+        ASSERT_EQ(v.Size(), SIZE - 1);
+        ASSERT_EQ(v[SIZE/2 - 1], 0);
+        ASSERT_EQ(v[SIZE/2], 1);
+        ASSERT_EQ(v[SIZE - 2], static_cast<int>(SIZE/2 - 1));
+    }
+}
+
+TEST(Vector, EraseRange) {
+    using namespace cstl;
+
+    const size_t SIZE = 10;
+
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        for (size_t i = 0; i < SIZE; ++i)
+            v.EmplaceBack(static_cast<int>(i));
+
+        auto pos = v.Erase(v.cbegin() + 2, v.cbegin() + 5);
+        ASSERT_EQ(pos - v.begin(), 2);
+        ASSERT_EQ(v.Size(), SIZE - 3);
+        ASSERT_EQ(v[2].id, 5);
+        ASSERT_EQ(Obj::num_move_assigned, SIZE - 5);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), SIZE - 3);
+
+        pos = v.Erase(v.cbegin() + 1, v.cbegin() + 1);
+        ASSERT_EQ(pos->id, 1);
+        v.Erase(v.cbegin(), v.cend());
+        ASSERT_EQ(v.Size(), 0);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (size_t i = 0; i < SIZE; ++i)
+            v.PushBack(std::make_unique<int>(i));
+        v.Erase(v.cbegin() + 1, v.cbegin() + 9);
+        ASSERT_EQ(v.Size(), 2);
+        ASSERT_EQ(*v[0], 0);
+        ASSERT_EQ(*v[1], 9);
+    }
+}
+
+TEST(Vector, EraseIf) {
+    using namespace cstl;
+
+    const int SIZE = 1000;
+    const auto is_odd = [](const auto& value) {
+        return value.id % 2 != 0;
+    };
+
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        for (int i = 0; i < SIZE; ++i)
+            v.EmplaceBack(i);
+
+        ASSERT_EQ(EraseIf(v, is_odd), SIZE/2);
+        ASSERT_EQ(v.Size(), SIZE/2);
+        for (int i = 0; i < SIZE/2; ++i)
+            ASSERT_EQ(v[i].id, 2*i);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), SIZE/2);
+    }
+    {
+        RelocatableObj::ResetCounters();
+        Vector<RelocatableObj> v;
+        for (int i = 0; i < SIZE; ++i)
+            v.EmplaceBack(i);
+
+        ASSERT_EQ(EraseIf(v, is_odd), SIZE/2);
+        ASSERT_EQ(v.Size(), SIZE/2);
+        for (int i = 0; i < SIZE/2; ++i)
+            ASSERT_EQ(v[i].id, 2*i);
+        ASSERT_EQ(RelocatableObj::num_moved, 0);
+        ASSERT_EQ(RelocatableObj::num_destroyed, SIZE/2);
+
+        int calls = 0;
+        ASSERT_THROW(
+            v.EraseIf([&calls](const RelocatableObj& obj) {
+                if (++calls == 10)
+                    throw std::runtime_error("Oops");
+                return obj.id % 4 == 0;
+            }),
+            std::runtime_error
+        );
+        ASSERT_EQ(v.Size(), SIZE/2 - 5);
+        ASSERT_EQ(v[0].id, 2);
+        ASSERT_EQ(v[4].id, 18);
+        ASSERT_EQ(v[5].id, 20);
+    }
+}
+
+TEST(Vector, SwapErase) {
+    using namespace cstl;
+
+    const int SIZE = 10;
+
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v;
+        for (int i = 0; i < SIZE; ++i)
+            v.EmplaceBack(i);
+
+        auto pos = v.SwapErase(v.cbegin() + 2);
+        ASSERT_EQ(pos->id, SIZE - 1);
+        ASSERT_EQ(v.Size(), SIZE - 1);
+        ASSERT_EQ(Obj::num_move_assigned, 1);
+
+        pos = v.SwapErase(v.cbegin() + v.Size() - 1);
+        ASSERT_EQ(pos, v.end());
+        ASSERT_EQ(v.Size(), SIZE - 2);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), SIZE - 2);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < SIZE; ++i)
+            v.PushBack(std::make_unique<int>(i));
+        v.SwapErase(v.cbegin());
+        ASSERT_EQ(*v[0], SIZE - 1);
+        ASSERT_EQ(*v[1], 1);
+    }
+}
+
+TEST(Vector, AlignedStorage) {
+    using namespace cstl;
+
+    const size_t ALIGNMENT = 64;
+    const auto is_aligned = [ALIGNMENT](const void* p) {
+        return reinterpret_cast<std::uintptr_t>(p) % ALIGNMENT == 0;
+    };
+
+    {
+        AlignedVector<float, ALIGNMENT> v;
+        for (size_t i = 0; i < 1000; ++i) {
+            v.PushBack(static_cast<float>(i));
+            ASSERT_TRUE(is_aligned(v.begin()));
+        }
+        ASSERT_EQ(v.Capacity(), 1024);
+
+        AlignedVector<float, ALIGNMENT> v_copy(v);
+        ASSERT_TRUE(is_aligned(v_copy.begin()));
+        ASSERT_EQ(v_copy[999], 999.0f);
+    }
+    {
+        const size_t LANE = ALIGNMENT/sizeof(double);
+
+        AlignedVector<double, ALIGNMENT, true> v;
+        v.Reserve(LANE + 1);
+        ASSERT_EQ(v.Capacity(), 2*LANE);
+        ASSERT_TRUE(is_aligned(v.begin()));
+
+        v.Resize(2*LANE + 1);
+        ASSERT_EQ(v.Capacity(), 3*LANE);
+
+        v.Resize(v.Capacity());
+        v.PushBack(1.0);
+        ASSERT_EQ(v.Capacity(), 6*LANE);
+        ASSERT_TRUE(is_aligned(v.begin()));
+    }
+}
+
+TEST(Vector, ShrinkToFit) {
+    using namespace cstl;
+
+    const int SIZE = 100;
+
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v;
+        for (int i = 0; i < SIZE; ++i)
+            v.EmplaceBack(i);
+        v.Erase(v.cbegin() + 10, v.cend());
+        ASSERT_EQ(v.Capacity(), 128);
+
+        v.ShrinkToFit();
+        ASSERT_EQ(v.Capacity(), 10);
+        ASSERT_EQ(v.Size(), 10);
+        ASSERT_EQ(v[9].id, 9);
+        ASSERT_EQ(Obj::GetAliveObjectCount(), 10);
+
+        v.Clear();
+        v.ShrinkToFit();
+        ASSERT_EQ(v.Capacity(), 0);
+        ASSERT_EQ(v.begin(), nullptr);
+    }
+    ASSERT_EQ(Obj::GetAliveObjectCount(), 0);
+    {
+        Vector<size_t, MmapAllocator<size_t>> v(SIZE*1000);
+        v.Resize(SIZE);
+        v.ShrinkToFit();
+        ASSERT_EQ(v.Capacity(), SIZE);
+        ASSERT_EQ(v[SIZE - 1], 0);
+    }
+}
+
+TEST(Vector, ReclaimingGrowth) {
+    using namespace cstl;
+
+    const size_t PATIENCE = 4;
+    using Policy = ReclaimingGrowth<DoublingGrowth<>, 4, PATIENCE>;
+
+    Vector<int, std::allocator<int>, Policy> v;
+    for (int i = 0; i < 1024; ++i)
+        v.PushBack(i);
+    ASSERT_EQ(v.Capacity(), 1024);
+
+    // Above capacity/4 nothing is reclaimed
+    v.Resize(256);
+    for (size_t i = 0; i < 2*PATIENCE; ++i)
+        v.PushBack(0), v.PopBack();
+    ASSERT_EQ(v.Capacity(), 1024);
+
+    // Below it the buffer is kept for PATIENCE - 1 removals...
+    v.Resize(200);
+    for (size_t i = 0; i < PATIENCE - 2; ++i)
+        v.PopBack();
+    ASSERT_EQ(v.Capacity(), 1024);
+
+    // ...and halved relative to the size on the next one
+    v.PopBack();
+    ASSERT_EQ(v.Size(), 200 - PATIENCE + 1);
+    ASSERT_EQ(v.Capacity(), 2*v.Size());
+    ASSERT_EQ(v[v.Size() - 1], static_cast<int>(v.Size()) - 1);
+
+    // Growth resets the streak
+    for (size_t i = 0; i < PATIENCE - 1; ++i)
+        v.Erase(v.cbegin());
+    while (v.Size() < v.Capacity())
+        v.PushBack(0);
+    v.PushBack(0);
+    const size_t grown = v.Capacity();
+    v.Resize(1);
+    for (size_t i = 0; i < PATIENCE - 2; ++i)
+        v.Resize(1);
+    ASSERT_EQ(v.Capacity(), grown);
+
+    // The streak moves with the buffer
+    Vector<int, std::allocator<int>, Policy> moved;
+    moved = std::move(v);
+    moved.Clear();
+    ASSERT_EQ(moved.Capacity(), 0);
+}
+
+TEST(Vector, Constexpr) {
+    using namespace cstl;
+
+    // Built in constant evaluation, then copied out of the transient
+    // allocation into an array
+    static constexpr auto squares = [] {
+        Vector<int> v;
+        for (int i = 0; i < 16; ++i)
+            v.PushBack(i*i);
+        v.Insert(v.begin(), -1);
+        v.Emplace(v.begin() + 3, 100);
+        v.Erase(v.begin());
+        v.Erase(v.begin() + 2);
+        EraseIf(v, [](int x) { return x % 2; });
+        v.SwapErase(v.begin());
+        v.ShrinkToFit();
+
+        std::array<int, 8> table{};
+        std::copy(v.begin(), v.end(), table.begin());
+        return table;
+    }();
+    static_assert(squares == std::array{196, 4, 16, 36, 64, 100, 144, 0});
+
+    static constexpr auto strings = [] {
+        Vector<std::string> v(3);
+        v[0] = "a";
+        v.EmplaceBack(5, 'b');
+        v.Insert(v.begin() + 1, 2, "c");
+        Vector<std::string> copy(v);
+        copy.Resize(4);
+        copy.PopBack();
+
+        size_t total = 0;
+        for (const std::string& s : copy)
+            total += s.size();
+        return total + 10*copy.Size();
+    }();
+    static_assert(strings == 3 + 10*3);
+}
+
+#if defined(__linux__)
+TEST(Vector, MmapAllocator) {
+    using namespace cstl;
+    using namespace std::literals;
+
+    const size_t SIZE = 1'000'000;
+
+    static_assert(RawMemory<int, MmapAllocator<int>>::CanReallocate());
+    static_assert(!RawMemory<int>::CanReallocate());
+
+    {
+        // The whole first page is usable
+        Vector<int, MmapAllocator<int>> v;
+        v.PushBack(1);
+        ASSERT_EQ(v.Capacity(), MmapAllocator<int>::Granularity()/sizeof(int));
+    }
+
+    {
+        Vector<size_t, MmapAllocator<size_t>> v;
+        for (size_t i = 0; i < SIZE; ++i)
+            v.PushBack(i);
+        v.Insert(v.cbegin() + 1, v[SIZE - 1]);
+        v.Erase(v.cbegin());
+        v.Reserve(SIZE*8);
+
+        ASSERT_EQ(v.Size(), SIZE);
+        ASSERT_EQ(v.Capacity(), SIZE*8);
+        ASSERT_EQ(v[0], SIZE - 1);
+        for (size_t i = 1; i < SIZE; ++i)
+            ASSERT_EQ(v[i], i);
+
+        std::vector<size_t> tail(SIZE*8, 0);
+        v.Insert(v.cbegin() + 1, tail.begin(), tail.end());
+        ASSERT_EQ(v.Size(), SIZE*9);
+        ASSERT_EQ(v[SIZE*8], 0);
+        ASSERT_EQ(v[SIZE*8 + 1], 1);
+        ASSERT_EQ(v[SIZE*9 - 1], SIZE - 1);
+    }
+    {
+        Vector<std::unique_ptr<int>, MmapAllocator<std::unique_ptr<int>, true>> v;
+        v.EmplaceBack(new int(1));
+        v.Emplace(v.cbegin(), new int(0));
+        ASSERT_EQ(*v[0], 0);
+        ASSERT_EQ(*v[1], 1);
+    }
+    {
+        // Not trivially relocatable: grows by allocate-move-free
+        Vector<std::string, MmapAllocator<std::string>> v;
+        for (size_t i = 0; i < 100; ++i)
+            v.PushBack(std::to_string(i) + "-long-enough-to-leave-sso"s);
+        ASSERT_EQ(v[99], "99-long-enough-to-leave-sso"s);
+    }
+}
+#endif
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();